@@ -2,49 +2,26 @@
 #include "Utils.h"
 #include "math.h"
 
-Aircraft::Aircraft(AircraftIdentification id, sf::RenderWindow* app, sf::Font* font, std::shared_ptr<Airport> airport)
-  : app_(app),
-    font_(font),
-    name_(id.name),
+Aircraft::Aircraft(AircraftIdentification id, std::shared_ptr<Airport> airport, std::mt19937* rng,
+                   KinematicsTable* kinematics, int slot)
+  : name_(id.name),
     model_(id.model),
+    texture_file_(id.texture_file),
     length_(id.length),
     width_(id.width),
     max_ground_deacceleration_(id.max_ground_deacceleration),
-    airport_(airport) {
-  if (!texture_.loadFromFile(id.texture_file)) {
-    std::cout << "Aircraft texture load failed: " << id.texture_file << std::endl;
-  }
-  texture_.setSmooth(true);
-  sf::Vector2u texture_size = texture_.getSize();
-  sprite_.setTexture(texture_);
-  sprite_.setOrigin(texture_size.x / 2, texture_size.y / 2);
-  sprite_.setScale(length_ / texture_size.x, width_ / texture_size.y);
-  sprite_.setPosition(sf::Vector2f(rand()%5000 + 5000, rand()%5000 + 5000));
-
-  position_circle_.setRadius(5);
-  position_circle_.setFillColor(sf::Color::Red);
-  position_circle_.setOrigin(5,5);
-
-  tag_.setFont(*font_);
-  tag_.setString(name_);
-  tag_.setCharacterSize(25);
-  tag_.setOrigin(tag_.getLocalBounds().width/2, tag_.getLocalBounds().height/2);
-  tag_.setFillColor(sf::Color::Yellow);
+    kinematics_(kinematics),
+    slot_(slot),
+    airport_(airport),
+    rng_(rng) {
+  // far away from the airport until touch down
+  float x = RandomInt(*rng_, 5000, 9999);
+  float y = RandomInt(*rng_, 5000, 9999);
+  position_ = sf::Vector2f(x, -y);
 
   stage_ = STAGE::TAXI_TO_GATE;
   state_ = STATE::MAINTAIN;
 
-  if (route_) {
-    target_speed_ = KnotsToMetersPerSecond(route_->GetTaxiSpeedLimit());
-  }
-
-  circle_indicator_.setFillColor(sf::Color::Transparent);
-  circle_indicator_.setOutlineThickness(3);
-  circle_indicator_.setOutlineColor(sf::Color::Transparent);
-  float circle_indicator_radius = 15;
-  circle_indicator_.setRadius(circle_indicator_radius);
-  circle_indicator_.setOrigin(circle_indicator_radius, circle_indicator_radius);
-
   // determine size, for gate selection use
   if (length_ <= 25 && width_ <= 25) {
     size_ = 1;
@@ -58,14 +35,49 @@ Aircraft::Aircraft(AircraftIdentification id, sf::RenderWindow* app, sf::Font* f
   }
 }
 
-void Aircraft::SetSpeed(float speed) { speed_ = speed; }
-float Aircraft::GetSpeed() { return speed_; }
-void Aircraft::SetAcceleration(float accel) { acceleration_ = accel; }
+void Aircraft::SetSpeed(float speed) { Speed() = speed; }
+float Aircraft::GetSpeed() { return Speed(); }
+void Aircraft::SetAcceleration(float accel) { Acceleration() = accel; }
 float Aircraft::GetMaxGroundDeacceleration() { return max_ground_deacceleration_; }
 std::string Aircraft::GetName() { return name_; }
 std::string Aircraft::GetModel() { return model_; }
-void Aircraft::PushBackClearanceReceived() { clearance_of_push_back_received_ = true; }
+std::string Aircraft::GetTextureFile() { return texture_file_; }
+std::string Aircraft::GetStatus() { return status_; }
+float Aircraft::GetTouchDownTime() { return touch_down_time_; }
+void Aircraft::SetTouchDownTime(float time) { touch_down_time_ = time; }
+void Aircraft::PushBackClearanceReceived() {
+  clearance_of_push_back_received_ = true;
+  RequestWake();
+}
 bool Aircraft::IsPushBackRequestSent() { return request_of_push_back_sent_; }
+void Aircraft::AssignTakeOffRunway(std::string runway) {
+  take_off_runway_ = runway;
+  take_off_runway_assigned_ = true;
+  RequestWake();
+}
+void Aircraft::LineUpClearanceReceived() {
+  clearance_of_line_up_received_ = true;
+  RequestWake();
+}
+void Aircraft::TakeOffClearanceReceived() {
+  clearance_of_line_up_received_ = true;
+  clearance_of_take_off_received_ = true;
+  RequestWake();
+}
+void Aircraft::HoldTaxi() {
+  manual_taxi_hold_ = true;
+  RequestWake();
+}
+void Aircraft::ResumeTaxi() {
+  manual_taxi_hold_ = false;
+  RequestWake();
+}
+void Aircraft::SetWakeRequests(std::vector<int>* wake_requests) { wake_requests_ = wake_requests; }
+void Aircraft::RequestWake() {
+  if (wake_requests_) {
+    wake_requests_->push_back(slot_);
+  }
+}
 std::string Aircraft::GetStageString() {
   switch (stage_) {
     case STAGE::TAXI_TO_GATE:
@@ -86,104 +98,205 @@ std::string Aircraft::GetStageString() {
   }
 }
 
-void Aircraft::SetTaxiRoutes(std::list<std::string> routes) { taxi_routes_ = routes; }
+void Aircraft::SetTaxiRoutes(const TaxiRoute& routes) {
+  taxi_path_.Compile(routes, GetDirectionOnRoute(), DistanceOnRoute());
+  ClearLeaderLink();
+}
+
 std::string Aircraft::GetTaxiRoutesString() {
-  std::string routes = "";
-  for (auto& r : taxi_routes_) {
-    routes += r;
-    routes += ">";
+  return taxi_path_.ToString();
+}
+
+void Aircraft::MoveAlongTaxiPath(float delta_distance) {
+  if (!taxi_path_.Advance(delta_distance)) {
+    return;
   }
-  if (routes.size() >= 1 && routes.substr(routes.size()-1, 1) == ">") {
-    routes = routes.substr(0, routes.size() - 1);
+  FollowTaxiPath();
+}
+
+void Aircraft::FollowTaxiPath() {
+  RouteBase*& route = kinematics_->Route(slot_);
+  RouteBase* previous_route = route;
+  float previous_distance = DistanceOnRoute();
+  if (taxi_path_.GetRoute() != previous_route) {
+    // left while its distance is still the one on the previous route
+    previous_route->ClearAircraft(shared_from_this());
   }
-  return routes;
+  route = taxi_path_.GetRoute();
+  bool direction = taxi_path_.GetDirectionOnRoute();
+  float distance = taxi_path_.GetDistanceOnRoute();
+  SetDirectionOnRoute(direction);
+  DistanceOnRoute() = distance;
+  if (route != previous_route) {
+    route->InsertAircraft(shared_from_this());
+  } else if (distance != previous_distance) {
+    route->MoveAircraft(this, previous_distance, distance);
+  }
+  position_ = route->GetBreakOutPosition(distance);
+  heading_ = route->GetRotation(distance, direction);
 }
 
 void Aircraft::SetGroundRoute(RouteBase* route, bool direction, float dist) {
-  if (route_) {
-    route_->ClearAircraft(shared_from_this());
+  RouteBase*& current_route = kinematics_->Route(slot_);
+  if (current_route) {
+    current_route->ClearAircraft(shared_from_this());
   }
-  route_ = route;
-  route_->InsertAircraft(shared_from_this());
-  target_speed_ = KnotsToMetersPerSecond(route_->GetTaxiSpeedLimit());
-  direction_on_route_ = direction;
-  distance_on_route_ = dist;
-  name_to_route_map_.insert({route_->GetName(), route_});
+  current_route = route;
+  target_speed_ = KnotsToMetersPerSecond(route->GetTaxiSpeedLimit());
+  SetDirectionOnRoute(direction);
+  DistanceOnRoute() = dist;
+  route->InsertAircraft(shared_from_this());
+  ClearLeaderLink();
+  name_to_route_map_.insert({route->GetName(), route});
 }
 
-float Aircraft::DetermineAcceleration(float target_speed, float dt,
-                                      float max_acceleration_allowed,
-                                      float max_deacceleration_allowed) {
-  return (target_speed > speed_) ?
-          std::min((target_speed - speed_) / dt, max_acceleration_allowed) :
-          std::max((target_speed - speed_) / dt, max_deacceleration_allowed);
-}
-
-void Aircraft::ComputeDistanceToBreak() {
-  // current speed
-  // next speed
-  // v_2^2 - v_1^2 = 2 * a * s;
-  int taxi_routes_size = taxi_routes_.size();
-
-  if (taxi_routes_size == 0) distance_to_break_ = -1;
-  if (taxi_routes_size > 1) {
-    float current_speed_limit = route_->GetTaxiSpeedLimit();
-    float next_speed_limit = route_->GetConnectionInfo(*std::next(taxi_routes_.begin())).next_piece->GetTaxiSpeedLimit();
-    if (next_speed_limit > current_speed_limit) {
-      distance_to_break_ = -1;
-    } else {
-      float s = (next_speed_limit*next_speed_limit - current_speed_limit*current_speed_limit)/2/soft_ground_deacceleration_;
-      if(direction_on_route_) {
-        distance_to_break_ = route_->GetLength() - s;
-      } else {
-        distance_to_break_ = s;
+std::shared_ptr<Aircraft> Aircraft::FindLeader(float follow_distance, float dt) {
+  LeaderLink& link = leader_link_;
+  link.age += dt;
+  double travelled = taxi_path_.GetTravelledDistance() - link.travelled;
+  // the skin is used up by this aircraft moving on and by anything else
+  // possibly closing in from beyond the search
+  bool search = !link.valid || link.runway_traffic ||
+                follow_distance + travelled + link.age * LEADER_MAX_CLOSING_SPEED > link.search_distance;
+  search = search || !IsLeaderLinkCurrent();
+  std::shared_ptr<Aircraft> leader = link.leader.lock();
+  if (!search && link.leader_route && (!leader || leader->GetRoute() != link.leader_route)) {
+    search = true;
+  }
+
+  if (search) {
+    link.valid = true;
+    link.search_distance = follow_distance + LEADER_SEARCH_SKIN;
+    link.travelled = taxi_path_.GetTravelledDistance();
+    link.age = 0;
+    link.routes.clear();
+    link.versions.clear();
+    travelled = 0;
+    float search_distance = link.search_distance;
+    bool direction = GetDirectionOnRoute();
+    leader = GetRoute()->ClosestAircraftInWay(shared_from_this(), search_distance,
+                                              direction, GetDistanceOnRoute(), &link.routes);
+    link.leader = leader;
+    link.runway_traffic = false;
+    for (auto route : link.routes) {
+      link.versions.push_back(route->GetOccupancyVersion());
+      int others = route->GetNumOfOccupants() - (route == GetRoute() ? 1 : 0);
+      if (route->GetRouteType() == RouteType::RUNWAY && others > 0) {
+        link.runway_traffic = true;
       }
     }
+    link.leader_route = nullptr;
+    if (leader) {
+      link.gap = search_distance;
+      link.leader_route = leader->GetRoute();
+      link.leader_distance = leader->GetDistanceOnRoute();
+      link.leader_route_direction = direction;
+    }
   }
-  if (taxi_routes_size == 1) {
-    float current_speed_limit = route_->GetTaxiSpeedLimit();
-    float s = current_speed_limit*current_speed_limit/2/soft_ground_deacceleration_;
-    if(direction_on_route_) {
-      distance_to_break_ = route_->GetLength() - s;
-    } else {
-      distance_to_break_ = s;
+  if (!leader) {
+    return nullptr;
+  }
+
+  // both moved since the search, the leader on the same route
+  float leader_moved = leader->GetDistanceOnRoute() - link.leader_distance;
+  float gap = link.gap - travelled + (link.leader_route_direction ? leader_moved : -leader_moved);
+  return gap < follow_distance ? leader : nullptr;
+}
+
+void Aircraft::ClearLeaderLink() {
+  // the vectors keep their capacity for the next searches
+  LeaderLink link;
+  link.routes.swap(leader_link_.routes);
+  link.versions.swap(leader_link_.versions);
+  link.routes.clear();
+  link.versions.clear();
+  leader_link_ = std::move(link);
+}
+
+bool Aircraft::IsLeaderLinkCurrent() {
+  LeaderLink& link = leader_link_;
+  for (int i = 0; i < int(link.routes.size()); i++) {
+    if (link.routes[i]->GetOccupancyVersion() != link.versions[i]) {
+      return false;
     }
   }
+  return true;
+}
+
+void Aircraft::StartCruise(float dt) {
+  cruise_.active = true;
+  cruise_.start = kinematics_->GetNumOfIntegrations();
+  cruise_.delta = GetDeltaDistance();
+  cruise_.dt = dt;
+  SetMoving(false);
+  GetRoute()->SetCruiser(this);
+  GetRoute()->Watch(this);
+  for (auto route : leader_link_.routes) {
+    route->Watch(this);
+  }
 }
 
-void Aircraft::Draw() {
-  if (!active_) {
+void Aircraft::EndCruise() {
+  if (!cruise_.active) {
     return;
   }
-  app_->draw(sprite_);
-  tag_.setPosition(sprite_.getPosition() + sf::Vector2f(0, 30));
-  app_->draw(tag_);
-  position_circle_.setPosition(sprite_.getPosition());
-  app_->draw(position_circle_);
-  circle_indicator_.setPosition(sprite_.getPosition());
-  app_->draw(circle_indicator_);
-}
-
-sf::FloatRect Aircraft::GetGlobalBounds() {
-  return sprite_.getGlobalBounds();
-}
-
-bool Aircraft::Intersect(std::shared_ptr<Aircraft> another_aircraft) {
-  sf::Rect<float> rect;
-  float r1 = std::min(width_, length_) / 2;
-  float r2 = std::min(another_aircraft->GetWidth(), another_aircraft->GetLength()) / 2;
-  auto pos1 = GetPosition();
-  auto pos2 = another_aircraft->GetPosition();
-  auto res = sqrt((pos1.x-pos2.x)*(pos1.x-pos2.x) + (pos1.y-pos2.y)*(pos1.y-pos2.y)) <= r1 + r2;
-  if (res) {
-    std::cout << "Distance: " << sqrt((pos1.x-pos2.x)*(pos1.x-pos2.x) + (pos1.y-pos2.y)*(pos1.y-pos2.y)) << "r1+r2 = " << r1 + r2 << std::endl;
+  cruise_.active = false;
+  GetRoute()->SetCruiser(nullptr);
+  GetRoute()->Unwatch(this);
+  for (auto route : leader_link_.routes) {
+    route->Unwatch(this);
   }
-  return res;
-  // auto res = sprite_.getGlobalBounds().intersects(another_aircraft->GetGlobalBounds(), rect);
+  // the sums of the ticks skipped, in the same order, so the path is where
+  // stepping tick by tick would have left it
+  long long ticks = kinematics_->GetNumOfIntegrations() - cruise_.start;
+  for (long long i = 0; i < ticks; i++) {
+    leader_link_.age += cruise_.dt;
+    DistanceToNextHold() -= cruise_.delta;
+    taxi_path_.Advance(cruise_.delta);
+  }
+  SetMoving(true);
+  FollowTaxiPath();
+}
+
+void Aircraft::OnTrafficAheadChanged() {
+  RequestWake();
+}
+
+double Aircraft::GetCruiseTravelledDistance() {
+  long long ticks = kinematics_->GetNumOfIntegrations() - cruise_.start;
+  return taxi_path_.GetTravelledDistance() + double(cruise_.delta) * ticks;
+}
+
+float Aircraft::DetermineAcceleration(float target_speed, float dt,
+                                      float max_acceleration_allowed,
+                                      float max_deacceleration_allowed) {
+  float speed = Speed();
+  return (target_speed > speed) ?
+          std::min((target_speed - speed) / dt, max_acceleration_allowed) :
+          std::max((target_speed - speed) / dt, max_deacceleration_allowed);
+}
+
+bool Aircraft::Intersect(Aircraft& another_aircraft) {
+  float r = GetRadius() + another_aircraft.GetRadius();
+  sf::Vector2f position = GetPosition();
+  sf::Vector2f another_position = another_aircraft.GetPosition();
+  float dx = position.x - another_position.x;
+  float dy = position.y - another_position.y;
+  return dx * dx + dy * dy <= r * r;
 }
 
 sf::Vector2f Aircraft::GetPosition() {
-  return sprite_.getPosition();
+  if (cruise_.active) {
+    return GetRoute()->GetBreakOutPosition(GetDistanceOnRoute());
+  }
+  return position_;
+}
+
+float Aircraft::GetHeading() {
+  if (cruise_.active) {
+    return GetRoute()->GetRotation(GetDistanceOnRoute(), GetDirectionOnRoute());
+  }
+  return heading_;
 }
 
 float Aircraft::GetWidth() {
@@ -194,20 +307,31 @@ float Aircraft::GetLength() {
   return length_;
 }
 
+float Aircraft::GetRadius() {
+  return std::min(width_, length_) / 2;
+}
+
 RouteBase* Aircraft::GetRoute() {
-  return route_;
+  return kinematics_->Route(slot_);
 }
 
 bool Aircraft::GetDirectionOnRoute() {
-  return direction_on_route_;
+  return kinematics_->GetDirectionOnRoute(slot_);
 }
 
 float Aircraft::GetDistanceOnRoute() {
-  return distance_on_route_;
+  if (cruise_.active) {
+    return taxi_path_.GetDistanceOnRouteAt(GetCruiseTravelledDistance());
+  }
+  return DistanceOnRoute();
 }
 
-std::list<std::string> Aircraft::GetTaxiRoutes() {
-  return taxi_routes_;
+int Aircraft::GetSlot() {
+  return slot_;
+}
+
+TaxiRouteView Aircraft::GetTaxiRoutes() const {
+  return taxi_path_.GetRoutes();
 }
 
 void Aircraft::SetLandingRunwayInfo(std::shared_ptr<RunwayInfo> runway_info) {
@@ -242,10 +366,6 @@ bool Aircraft::CanBeDeleted() {
   return can_be_deleted_;
 }
 
-void Aircraft::SetCircleIndicatorColor(sf::Color color) {
-  circle_indicator_.setOutlineColor(color);
-}
-
 int Aircraft::GetSize() {
   return size_;
 }
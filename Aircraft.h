@@ -2,13 +2,27 @@
 #define AIRCRAFT_H
 
 #include <iostream>
+#include <random>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
-#include <SFML/Graphics.hpp>
+#include <SFML/System/Vector2.hpp>
 #include "Airport.h"
+#include "KinematicsTable.h"
 #include "RouteBase.h"
 #include "StateMachine.h"
+#include "TaxiPath.h"
+#include "TaxiRoute.h"
 #include "Utils.h"
 
+// Extra distance the leader search looks ahead, meter
+#define LEADER_SEARCH_SKIN 50
+// Fastest any other aircraft off the runways is taken to close in on the
+// search, m/s, about the top taxi speed. Landing and take off rolls are
+// much faster, see LeaderLink.
+#define LEADER_MAX_CLOSING_SPEED 15.5
+
 struct AircraftFlyingStates {
   float speed;
   float elevation;
@@ -42,6 +56,39 @@ struct AircraftIdentification {
   float max_ground_deacceleration;
 };
 
+// Leader kept between searches, in the way of a Verlet list: the search
+// looks skin meters further than needed, and aircraft already on the routes
+// searched close in at taxi speed at most. So until the aircraft has used
+// up the skin the answer can only change if the routes searched get or lose
+// an occupant or the leader changes route. A runway searched with someone
+// else on it breaks the speed bound, the search then runs every time.
+struct LeaderLink {
+  bool valid = false;
+  // not owned, two aircraft head-on are each other's leader
+  std::weak_ptr<Aircraft> leader;
+  bool runway_traffic = false;    // a runway searched has another occupant
+  float search_distance = 0;      // how far ahead the search looked
+  double travelled = 0;           // own taxi path distance at the search
+  float age = 0;                  // seconds since the search
+  std::vector<RouteBase*> routes; // searched, with their occupancy version
+  std::vector<int> versions;
+  // leader only, its route, where it was and which way that route is taken.
+  // leader_route is nullptr if the search found none.
+  float gap = 0;
+  RouteBase* leader_route = nullptr;
+  float leader_distance = 0;
+  bool leader_route_direction = true;
+};
+
+// A cruise, see Aircraft::StartCruise. Ticks run since it started move the
+// aircraft delta each, along the taxi path from where it stopped.
+struct AircraftCruise {
+  bool active = false;
+  long long start = 0; // Integrate calls of the kinematics table at the start
+  float delta = 0;     // meter per tick
+  float dt = 0;        // seconds per tick
+};
+
 struct AircraftFlyingDisplay {
 
 };
@@ -69,6 +116,7 @@ class Aircraft : public std::enable_shared_from_this<Aircraft>
   };
 
   friend class StateMachine;
+  friend class VariantStateMachine;
   friend class State;
   friend class Banner;
   friend class InitialState;
@@ -84,27 +132,48 @@ class Aircraft : public std::enable_shared_from_this<Aircraft>
   friend class LeavingState;
 
   public:
-    Aircraft(AircraftIdentification id, sf::RenderWindow* app, sf::Font* font, std::shared_ptr<Airport> airport);
+    // Pure simulation data, nothing is drawn here. See AircraftView for the
+    // display of an aircraft. rng is the random engine of the simulation,
+    // the kinematic state lives in slot of the kinematics table.
+    Aircraft(AircraftIdentification id, std::shared_ptr<Airport> airport, std::mt19937* rng,
+             KinematicsTable* kinematics, int slot);
     virtual ~Aircraft();
 
     // Get set properties
     std::string GetName();
     std::string GetModel();
+    std::string GetTextureFile();
     float GetWidth();
     float GetLength();
+    // Radius of the circle used for conflicts, half the smaller dimension
+    float GetRadius();
     int GetSize(); // 1-small, 2-medium and 3-large
 
     void SetSpeed(float speed);
     float GetSpeed();
+    // World coordinates, meter
     sf::Vector2f GetPosition();
-
-    void SetTaxiRoutes(std::list<std::string> routes);
-    std::list<std::string> GetTaxiRoutes();
+    // World degree the nose points to
+    float GetHeading();
+    // What the aircraft is doing, e.g. "TAXI TO G1", for display
+    std::string GetStatus();
+    // Simulation time the aircraft is expected to touch down, negative once
+    // landed
+    float GetTouchDownTime();
+    void SetTouchDownTime(float time);
+
+    // Compile routes into the taxi path, starting from the current route,
+    // direction and distance on route.
+    void SetTaxiRoutes(const TaxiRoute& routes);
+    // Remaining taxi routes, the first one is the current route
+    TaxiRouteView GetTaxiRoutes() const;
     std::string GetTaxiRoutesString();
 
     RouteBase* GetRoute();
     bool GetDirectionOnRoute();
     float GetDistanceOnRoute();
+    // Slot of the aircraft in the kinematics table
+    int GetSlot();
 
     void SetLandingRunwayInfo(std::shared_ptr<RunwayInfo>);
     std::shared_ptr<RunwayInfo> GetLandingRunwayInfo();
@@ -117,16 +186,38 @@ class Aircraft : public std::enable_shared_from_this<Aircraft>
 
     std::string GetStageString();
 
-    void ComputeDistanceToBreak();
-    void Draw();
-
 
+    // Answers of the controller. Each one adds the slot of the aircraft to
+    // the wake requests, an aircraft waiting for it or cruising is updated
+    // again.
     void PushBackClearanceReceived();
     bool IsPushBackRequestSent();
-
-
-    sf::FloatRect GetGlobalBounds();
-    bool Intersect(std::shared_ptr<Aircraft> another_aircraft);
+    void AssignTakeOffRunway(std::string runway); // in the form of "+R1" or "-R1"
+    void LineUpClearanceReceived();
+    void TakeOffClearanceReceived();
+    void HoldTaxi();
+    void ResumeTaxi();
+    // Owned by the simulation, nullptr if none
+    void SetWakeRequests(std::vector<int>* wake_requests);
+
+
+    // Drop the leader link, once the aircraft is off the ground or removed
+    void ClearLeaderLink();
+
+    // Whether the conflict circles overlap, no square root taken
+    bool Intersect(Aircraft& another_aircraft);
+
+    // Cruise at the speed of the last tick with nothing integrated or moved
+    // for it, the table slot stands still. Route, distance, position and
+    // heading are worked out from the ticks run whenever they are read. Its
+    // route and the routes of the leader link are watched, the aircraft is
+    // told once one of them changes occupancy. EndCruise catches the taxi
+    // path up, as if it had moved tick by tick.
+    void StartCruise(float dt);
+    void EndCruise();
+    bool IsCruising() { return cruise_.active; }
+    // A watched route got or lost an occupant
+    void OnTrafficAheadChanged();
 
 
     void Activate();
@@ -135,23 +226,46 @@ class Aircraft : public std::enable_shared_from_this<Aircraft>
     void Delete();
     bool CanBeDeleted();
 
-    void SetCircleIndicatorColor(sf::Color color);
-
 
   protected:
 
   private:
+    // The kinematic state of this aircraft in the table
+    float& Speed() { return kinematics_->Speed(slot_); }
+    float& Acceleration() { return kinematics_->Acceleration(slot_); }
+    float& DistanceOnRoute() { return kinematics_->DistanceOnRoute(slot_); }
+    float& DistanceToNextHold() { return kinematics_->DistanceToNextHold(slot_); }
+    void SetDirectionOnRoute(bool direction) { kinematics_->SetDirectionOnRoute(slot_, direction); }
+    void SetMoving(bool moving) { kinematics_->SetMoving(slot_, moving); }
+    float GetDeltaDistance() { return kinematics_->GetDeltaDistance(slot_); }
+    // After a command of the controller
+    void RequestWake();
+
+    // Closest aircraft ahead on the taxi path closer than follow_distance,
+    // nullptr if none. Searches again only when the leader link can not
+    // answer any more, dt is the time since the last call.
+    std::shared_ptr<Aircraft> FindLeader(float follow_distance, float dt);
+    // Whether the routes of the last leader search are occupied as they
+    // were, only the aircraft on them moved since
+    bool IsLeaderLinkCurrent();
+    // s on the taxi path the cruise has reached by now
+    double GetCruiseTravelledDistance();
+
     float DetermineMaxTaxiSpeed(RouteType type);
+    // Move delta_distance along the taxi path, then FollowTaxiPath
+    void MoveAlongTaxiPath(float delta_distance);
+    // Update route, direction and distance on route to where the taxi path
+    // is, as well as the aircraft set of the routes left. Position and
+    // heading follow the new place on the route.
+    void FollowTaxiPath();
     float DetermineAcceleration(float target_speed, float dt,
                                 float max_acceleration_allowed,
                                 float max_deacceleration_allowed);
 
   private:
-    sf::RenderWindow* app_;
-    sf::Font* font_;
-
     std::string name_;
     std::string model_;
+    std::string texture_file_;
     float length_;
     float width_;
     int size_;  // 1-small, 2-medium, 3-large
@@ -160,27 +274,22 @@ class Aircraft : public std::enable_shared_from_this<Aircraft>
     float soft_ground_deacceleration_ = -0.5;
     float max_ground_acceleration_ = 2.0;
     float soft_ground_acceleration_ = 0.5;
-    float speed_; // meter per second
-    float acceleration_ = 0.0;
-
-    sf::Texture texture_;
-
-    // Ground display
-    sf::Sprite sprite_;
-
-    sf::CircleShape position_circle_;
-    sf::CircleShape circle_indicator_; // used to indicate when game over
 
-    sf::Text tag_;
+    // speed, acceleration, route, direction and distance on route, distance
+    // to the next hold point
+    KinematicsTable* kinematics_;
+    int slot_;
+    std::vector<int>* wake_requests_ = nullptr;
 
-    std::unordered_set<std::shared_ptr<Aircraft>> aircrafts_nearby_;
+    sf::Vector2f position_;
+    float heading_ = 0;
+    std::string status_ = "";
+    float touch_down_time_ = -1;
 
-    std::list<std::string> taxi_routes_;
+    LeaderLink leader_link_;
+    AircraftCruise cruise_;
 
-    RouteBase* route_ = nullptr;
-    bool direction_on_route_;
-    float distance_on_route_;
-    float distance_to_break_ = -1; // this is the critical position to break before enter the corner or stop.
+    TaxiPath taxi_path_;
 
     float max_taxi_speed_straight_ = KnotsToMetersPerSecond(30.0);
     float max_taxi_speed_arc_ = KnotsToMetersPerSecond(10.0);
@@ -221,9 +330,9 @@ class Aircraft : public std::enable_shared_from_this<Aircraft>
     std::string gate_assigned_ = "";
 
     HoldPointType next_hold_type_ = HoldPointType::NOTSET;
-    float distance_to_next_hold_ = -1; // negative number indicating needs to compute again
 
     std::shared_ptr<Airport> airport_ = nullptr;
+    std::mt19937* rng_ = nullptr;
 };
 
 #endif // AIRCRAFT_H
@@ -0,0 +1,56 @@
+#include "AircraftView.h"
+#include "Utils.h"
+
+AircraftView::AircraftView(std::shared_ptr<Aircraft> aircraft, sf::RenderWindow* app, sf::Font* font)
+  : aircraft_(aircraft),
+    app_(app),
+    font_(font) {
+  if (!texture_.loadFromFile(aircraft_->GetTextureFile())) {
+    std::cout << "Aircraft texture load failed: " << aircraft_->GetTextureFile() << std::endl;
+  }
+  texture_.setSmooth(true);
+  sf::Vector2u texture_size = texture_.getSize();
+  sprite_.setTexture(texture_);
+  sprite_.setOrigin(texture_size.x / 2, texture_size.y / 2);
+  sprite_.setScale(aircraft_->GetLength() / texture_size.x, aircraft_->GetWidth() / texture_size.y);
+
+  position_circle_.setRadius(5);
+  position_circle_.setFillColor(sf::Color::Red);
+  position_circle_.setOrigin(5,5);
+
+  tag_.setFont(*font_);
+  tag_.setString(aircraft_->GetName());
+  tag_.setCharacterSize(25);
+  tag_.setOrigin(tag_.getLocalBounds().width/2, tag_.getLocalBounds().height/2);
+  tag_.setFillColor(sf::Color::Yellow);
+
+  circle_indicator_.setFillColor(sf::Color::Transparent);
+  circle_indicator_.setOutlineThickness(3);
+  circle_indicator_.setOutlineColor(sf::Color::Transparent);
+  float circle_indicator_radius = 15;
+  circle_indicator_.setRadius(circle_indicator_radius);
+  circle_indicator_.setOrigin(circle_indicator_radius, circle_indicator_radius);
+}
+
+void AircraftView::Draw() {
+  if (!aircraft_->IsActive()) {
+    return;
+  }
+  sprite_.setPosition(ToSfmlPosition(aircraft_->GetPosition()));
+  sprite_.setRotation(ToSfmlRotation(aircraft_->GetHeading()));
+  app_->draw(sprite_);
+  tag_.setPosition(sprite_.getPosition() + sf::Vector2f(0, 30));
+  app_->draw(tag_);
+  position_circle_.setPosition(sprite_.getPosition());
+  app_->draw(position_circle_);
+  circle_indicator_.setPosition(sprite_.getPosition());
+  app_->draw(circle_indicator_);
+}
+
+sf::FloatRect AircraftView::GetGlobalBounds() {
+  return sprite_.getGlobalBounds();
+}
+
+void AircraftView::SetCircleIndicatorColor(sf::Color color) {
+  circle_indicator_.setOutlineColor(color);
+}
@@ -0,0 +1,33 @@
+#ifndef AIRCRAFTVIEW_H
+#define AIRCRAFTVIEW_H
+
+#include <memory>
+#include <SFML/Graphics.hpp>
+#include "Aircraft.h"
+
+// Sprite, tag and indicators of one aircraft, drawn where the simulation
+// put the aircraft.
+class AircraftView
+{
+  public:
+    AircraftView(std::shared_ptr<Aircraft> aircraft, sf::RenderWindow* app, sf::Font* font);
+
+    void Draw();
+    sf::FloatRect GetGlobalBounds();
+    void SetCircleIndicatorColor(sf::Color color);
+
+  private:
+    std::shared_ptr<Aircraft> aircraft_;
+    sf::RenderWindow* app_;
+    sf::Font* font_;
+
+    sf::Texture texture_;
+    sf::Sprite sprite_;
+
+    sf::CircleShape position_circle_;
+    sf::CircleShape circle_indicator_; // used to indicate when game over
+
+    sf::Text tag_;
+};
+
+#endif // AIRCRAFTVIEW_H
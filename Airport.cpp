@@ -517,11 +517,12 @@ Airport::Airport(sf::RenderWindow* app, sf::Font* font, float global_ds,
 }
 
 void Airport::BuildConnectionMatrix() {
-  // 1. build SegmentInfo
-  for (auto& r : runways_) { r->CreateSegments(); }
-  for (auto& t : taxiways_) { t->CreateSegments(); }
-  for (auto& a : arcways_) { a->CreateSegments(); }
-  for (auto& g : gates_) { g->CreateSegments(); }
+  // 1. build SegmentInfo, matrix ids are handed out in this order
+  int num_of_segments = 0;
+  for (auto& r : runways_) { num_of_segments = r->CreateSegments(num_of_segments); }
+  for (auto& t : taxiways_) { num_of_segments = t->CreateSegments(num_of_segments); }
+  for (auto& a : arcways_) { num_of_segments = a->CreateSegments(num_of_segments); }
+  for (auto& g : gates_) { num_of_segments = g->CreateSegments(num_of_segments); }
 
   // 2. populate intra-route segment info for connections
   for (auto& r : runways_) { r->PopulateIntraRouteConnection(); }
@@ -530,168 +531,147 @@ void Airport::BuildConnectionMatrix() {
   for (auto& g : gates_) { g->PopulateIntraRouteConnection(); }
 
   // 3. build matrix
-  // 3.1 build id2name and name2id map, and copy segments
-  int num_of_segments = 0;
+  // 3.1 copy segments, indexed by matrix id
+  segments_.clear();
+  segments_.reserve(num_of_segments);
   for (auto& r : runways_) {
-    auto segments = r->GetSegments();
-    for (auto& s : segments) {
-      matrix_id_to_name_.insert({num_of_segments, s.name});
-      name_to_matrix_id_.insert({s.name, num_of_segments});
-      num_of_segments++;
-      segments_.push_back(s);
-    }
+    auto& segments = r->GetSegments();
+    segments_.insert(segments_.end(), segments.begin(), segments.end());
   }
   for (auto& t : taxiways_) {
-    auto segments = t->GetSegments();
-    for (auto& s : segments) {
-      matrix_id_to_name_.insert({num_of_segments, s.name});
-      name_to_matrix_id_.insert({s.name, num_of_segments});
-      num_of_segments++;
-      segments_.push_back(s);
-    }
+    auto& segments = t->GetSegments();
+    segments_.insert(segments_.end(), segments.begin(), segments.end());
   }
   for (auto& a : arcways_) {
-    auto segments = a->GetSegments();
-    for (auto& s : segments) {
-      matrix_id_to_name_.insert({num_of_segments, s.name});
-      name_to_matrix_id_.insert({s.name, num_of_segments});
-      num_of_segments++;
-      segments_.push_back(s);
-    }
+    auto& segments = a->GetSegments();
+    segments_.insert(segments_.end(), segments.begin(), segments.end());
   }
   for (auto& g : gates_) {
-    auto segments = g->GetSegments();
-    for (auto& s : segments) {
-      matrix_id_to_name_.insert({num_of_segments, s.name});
-      name_to_matrix_id_.insert({s.name, num_of_segments});
-      num_of_segments++;
-      segments_.push_back(s);
-    }
+    auto& segments = g->GetSegments();
+    segments_.insert(segments_.end(), segments.begin(), segments.end());
   }
   // std::cout << "Total number of segments of this airport is:" << num_of_segments << std::endl;
-  // 3.2 build connection matrix
-  connection_matrix_ = std::vector<std::vector<float>>(num_of_segments, std::vector<float>(num_of_segments, float(INT_MAX)));
-  for (int i=0; i<num_of_segments; i++) {
-    for (int j=0; j<num_of_segments; j++) {
-      if (i==j) {connection_matrix_[i][j] = 0; continue;}
-      for (auto& name : segments_[i].out_segment) {
-        if (name == segments_[j].name) {
-          connection_matrix_[i][j] = segments_[i].length;
-          break;
-        }
-      }
+  // 3.2 build sparse connection graph
+  taxi_graph_.Build(segments_);
+  // std::cout << "Taxi graph finished: " << taxi_graph_.GetNumOfEdges() << " edges." << std::endl;
+
+  // 4. destinations are known, precompute their routes
+  BuildDestinationTrees();
+}
+
+void Airport::BuildDestinationTrees() {
+  destination_trees_.clear();
+  destination_tree_index_.clear();
+  std::vector<int> destination_ids;
+  for (auto& hp : holdpoints_) {
+    if (hp.type == HoldPointType::LINEUP) {
+      destination_ids.push_back(hp.route->GetSegmentId(hp.direction, hp.distance_on_route));
     }
   }
-  // std::cout << "Connection Matrix Finished." << std::endl;
-  for (int i=0; i<connection_matrix_.size(); i++) {
-    // std::cout << i << ": ";
-    for (int j=0; j<connection_matrix_[i].size(); j++) {
-      // std::cout << connection_matrix_[i][j] << " ";
+  for (auto& g : gates_) {
+    destination_ids.push_back(g->GetSegmentId(true, g->GetLength()));
+  }
+  for (auto id : destination_ids) {
+    if (id < 0 || destination_tree_index_.count(id) > 0) {
+      continue;
     }
-    // std::cout << std::endl;
+    destination_tree_index_[id] = destination_trees_.size();
+    destination_trees_.emplace_back();
+    destination_trees_.back().Build(taxi_graph_, id);
   }
 }
 
-RouteBase* Airport::GetSegmentRoute(std::string segment_name) {
-  for (auto& s : segments_) {
-    if (s.name == segment_name) {
-      return s.route;
-    }
+RouteBase* Airport::GetSegmentRoute(int segment_id) {
+  if (segment_id < 0 || segment_id >= int(segments_.size())) {
+    return nullptr;
   }
-  return nullptr;
+  return segments_[segment_id].route;
 }
 
-// return a minimum distance for the
-// vertex which is not included in visited.
-int FindIndexOfMinimumValue(std::vector<float> dist, std::vector<bool> visited) {
-  int n = dist.size();
-  float min_dist = INT_MAX;
-  int index;
+TaxiRoute Airport::SearchRoute(int src, int dst) const {
+  // Scratch buffers are reused by every query made on this thread.
+  thread_local RouteQuery query;
+  query.Bind(&taxi_graph_);
 
-  for (int i = 0; i < n; i++) {
-    if (!visited[i] && dist[i] <= min_dist) {
-      min_dist = dist[i];
-      index = i;
-    }
-  }
-  return index;
-}
-
-std::list<std::string> Airport::Dijkstra(std::vector<std::vector<float>> graph, int src, int dst) {
-  int n = graph.size();
-  std::vector<float> dist(n, INT_MAX); // integer array to calculate minimum distance for each node.
-  std::vector<bool> visited(n, false);// mark visted/unvisted for each node.
-  std::vector<int> from(n, -1);
-  int prev = -1;
-
-  dist[src] = 0; // Source vertex distance is set to zero.
-
-  for (int i = 0; i < n; i++) {
-    int index = FindIndexOfMinimumValue(dist, visited); // vertex not yet included.
-    // std::cout << "Index picked: " << std::to_string(index) << "    ";
-    prev = index;
-    visited[index] = true; // m with minimum distance included in visited.
-    for (int j = 0; j < n; j++) {
-      // Updating the minimum distance for the particular node.
-	  if (!visited[j] && (graph[index][j] > 0 && graph[index][j] < INT_MAX) && dist[index] != INT_MAX && dist[index] + graph[index][j] < dist[j]) {
-        dist[j] = dist[index] + graph[index][j];
-        if (from[j] == -1) {
-          // std::cout << "from[" << std::to_string(j) << "] set to " << std::to_string(index);
-          from[j] = index;
-        }
-      }
-    }
-    // std::cout << std::endl;
+  if (!query.Search(src, dst, route_search_mode_)) {
+    std::cout << "No route found from " << segments_[src].name << " to "
+              << segments_[dst].name << std::endl;
+    return TaxiRoute();
   }
+  return ToTaxiRoute(query.GetPath());
+}
 
-  // std::cout << "Print from:" << std::endl;
-  // for (int i=0; i<from.size(); i++) {
-  //   std::cout << std::to_string(i) << ": " << std::to_string(from[i]) << std::endl;
-  // }
-
-  // print result:
-  std::vector<int> result_id_list(0, 0);
-  // std::cout << dst << ": " << dist[dst] << std::endl;
-  int prev_id = dst;
-  do { result_id_list.push_back(prev_id);
-       prev_id = from[prev_id]; }
-  while (prev_id != src);
-  result_id_list.push_back(prev_id);
-  std::reverse(std::begin(result_id_list), std::end(result_id_list));
-
-  for (auto v : result_id_list) {
-    // std::cout << std::to_string(v) << " ";
+TaxiRoute Airport::ToTaxiRoute(const std::vector<int>& path) const {
+  TaxiRoute taxi_route;
+  for (auto v : path) {
+    RouteBase* route = segments_[v].route;
+    if (taxi_route.Empty() || taxi_route.Back() != route) {
+      taxi_route.PushBack(route);
+    }
   }
-  // std::cout << std::endl;
+  return taxi_route;
+}
 
-  std::vector<std::string> result_string_list;
-  for (auto v : result_id_list) {
-    result_string_list.push_back(matrix_id_to_name_[v]);
-    // std::cout << result_string_list.back() << " ";
+TaxiRoute Airport::GetRoute(RouteBase* start_route, bool start_direction, float start_dist,
+                       RouteBase* end_route, bool end_direction, float end_dist) {
+  int src = start_route->GetSegmentId(start_direction, start_dist);
+  int dst = end_route->GetSegmentId(end_direction, end_dist);
+  if (src < 0 || dst < 0) {
+    std::cout << "GetRoute: segment not found." << std::endl;
+    return TaxiRoute();
   }
-  // std::cout << std::endl;
-
-  std::list<std::string> route_list;
-  for (auto v : result_id_list) {
-    if (route_list.empty() ||
-        (route_list.back() != GetSegmentRoute(matrix_id_to_name_[v])->GetName())) {
-      route_list.push_back(GetSegmentRoute(matrix_id_to_name_[v])->GetName());
+  // std::cout << "ID1 and ID2: "<< src << " " << dst << std::endl;
+
+  // Line up points and gates have a precomputed tree, just walk it.
+  auto tree_iter = destination_tree_index_.find(dst);
+  if (tree_iter != destination_tree_index_.end()) {
+    thread_local std::vector<int> path;
+    if (destination_trees_[tree_iter->second].GetPath(src, path)) {
+      return ToTaxiRoute(path);
     }
+    std::cout << "No route found from " << segments_[src].name << " to "
+              << segments_[dst].name << std::endl;
+    return TaxiRoute();
   }
-  return route_list;
+  return SearchRoute(src, dst);
 }
 
-std::list<std::string> Airport::GetRoute(RouteBase* start_route, bool start_direction, float start_dist,
-                       RouteBase* end_route, bool end_direction, float end_dist) {
-  auto name1 = start_route->GetSegmentName(start_direction, start_dist);
-  auto name2 = end_route->GetSegmentName(end_direction, end_dist);
-
-  auto id1 = name_to_matrix_id_[name1];
-  auto id2 = name_to_matrix_id_[name2];
-  // std::cout << "ID1 and ID2: "<< id1 << " " << id2 << std::endl;
-
-  return Dijkstra(connection_matrix_, id1, id2);
+void Airport::BenchmarkRouteSearch(int repetitions) {
+  int n = taxi_graph_.GetNumOfNodes();
+  RouteQuery query(&taxi_graph_);
+  std::vector<std::pair<int, int>> pairs;
+  std::vector<float> dijkstra_distances;
+  for (int src = 0; src < n; src++) {
+    for (int dst = 0; dst < n; dst++) {
+      if (src != dst && query.Search(src, dst, RouteSearchMode::DIJKSTRA)) {
+        pairs.push_back({src, dst});
+        dijkstra_distances.push_back(query.GetDistance());
+      }
+    }
+  }
 
+  for (auto mode : {RouteSearchMode::DIJKSTRA, RouteSearchMode::ASTAR}) {
+    long long num_of_expanded_nodes = 0;
+    int num_of_mismatches = 0;
+    sf::Clock clock;
+    for (int r = 0; r < repetitions; r++) {
+      for (int i = 0; i < int(pairs.size()); i++) {
+        query.Search(pairs[i].first, pairs[i].second, mode);
+        num_of_expanded_nodes += query.GetNumOfExpandedNodes();
+        if (fabs(query.GetDistance() - dijkstra_distances[i]) > 0.01) {
+          num_of_mismatches++;
+        }
+      }
+    }
+    float seconds = clock.getElapsedTime().asSeconds();
+    int num_of_queries = int(pairs.size()) * repetitions;
+    std::cout << (mode == RouteSearchMode::ASTAR ? "A*      " : "Dijkstra")
+              << " queries: " << num_of_queries
+              << " total: " << seconds * 1000 << " ms"
+              << " per query: " << seconds * 1e6 / num_of_queries << " us"
+              << " expanded nodes per query: " << float(num_of_expanded_nodes) / num_of_queries
+              << " distance mismatches: " << num_of_mismatches << std::endl;
+  }
 }
 
 void Airport::AddRunway(LineParameter param, RunwayDetailsParam details_param, std::string airport_letter) {
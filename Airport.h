@@ -4,6 +4,8 @@
 #include <memory>
 #include <SFML/Graphics.hpp>
 #include "RouteBase.h"
+#include "TaxiGraph.h"
+#include "TaxiRoute.h"
 
 struct LandingPositionInfo {
   RouteBase* runway;
@@ -14,6 +16,8 @@ struct LandingPositionInfo {
 class Airport
 {
   public:
+  // app and font can be nullptr to run without a window, Draw must not be
+  // called then.
   Airport(sf::RenderWindow* app, sf::Font* font, float global_ds,
            float runway_width, sf::Color runway_color, float taxiway_width,
            sf::Color taxiway_color, float gate_length, float gate_width,
@@ -70,12 +74,31 @@ class Airport
     // Reset states of airport, to work with game restart
     void Reset();
 
-    RouteBase* GetSegmentRoute(std::string segment_name);
+    RouteBase* GetSegmentRoute(int segment_id);
 
-    std::list<std::string> GetRoute(RouteBase* start_route, bool start_direction, float start_dist,
-                                    RouteBase* end_route, bool end_direction, float end_dist);
+    // Routes to follow from start to end, empty if end can not be reached.
+    TaxiRoute GetRoute(RouteBase* start_route, bool start_direction, float start_dist,
+                       RouteBase* end_route, bool end_direction, float end_dist);
 
-    std::list<std::string> Dijkstra(std::vector<std::vector<float>> graph, int src, int dst);
+    // Shortest path between two segment ids on the taxi graph, returned as the
+    // routes to follow. Uses a per thread RouteQuery, so it can be called from
+    // several threads at once.
+    TaxiRoute SearchRoute(int src, int dst) const;
+
+    // Algorithm used by single pair route searches. Routes to line up points
+    // and gates always come from the precomputed trees.
+    void SetRouteSearchMode(RouteSearchMode mode) { route_search_mode_ = mode; }
+    RouteSearchMode GetRouteSearchMode() { return route_search_mode_; }
+
+    // Run every reachable segment pair with Dijkstra and with A*, print time
+    // and number of expanded nodes of both and check they agree on distances.
+    void BenchmarkRouteSearch(int repetitions);
+
+    // Taxi route of a segment path, consecutive segments on the same route merged.
+    TaxiRoute ToTaxiRoute(const std::vector<int>& path) const;
+
+    // Read only access to the taxi graph, e.g. to run a caller owned RouteQuery.
+    const TaxiGraph& GetTaxiGraph() const { return taxi_graph_; }
 
     // Return the holdpoint that matches the input takeoff runway name, e.g., +R1, -R1
     HoldPoint GetHoldPoint(std::string take_off_runway);
@@ -91,12 +114,17 @@ class Airport
 
 
   private:
-    // After the routes are completed, build this matrix for route searching algorithm.
-    // A route element, e.g., taxiway, can have multiple entries in the matrix if they
-    // have break in/out points. Each segment has two entries in the matrix if they allow
+    // After the routes are completed, build the taxi graph for route searching algorithm.
+    // A route element, e.g., taxiway, can have multiple nodes in the graph if they
+    // have break in/out points. Each segment has two nodes in the graph if they allow
     // traffic in both + and - directions.
     void BuildConnectionMatrix();
 
+    // Build one reverse shortest path tree for every fixed taxi destination:
+    // the LINEUP hold points and the gates. Must be called whenever the taxi
+    // graph is rebuilt.
+    void BuildDestinationTrees();
+
   private:
     sf::RenderWindow* app_;
     sf::Font* font_;
@@ -127,10 +155,11 @@ class Airport
 
     bool display_road_text_ = false;  // even if false, Gate text will still be displayed
 
-    std::vector<SegmentInfo> segments_;
-    std::unordered_map<int, std::string> matrix_id_to_name_;
-    std::unordered_map<std::string, int> name_to_matrix_id_;
-    std::vector<std::vector<float>> connection_matrix_;
+    std::vector<SegmentInfo> segments_; // indexed by matrix id
+    TaxiGraph taxi_graph_;
+    std::vector<ShortestPathTree> destination_trees_;
+    std::unordered_map<int, int> destination_tree_index_; // segment id -> index in destination_trees_
+    RouteSearchMode route_search_mode_ = RouteSearchMode::DIJKSTRA;
 
     bool mode_; // decided by the wind direction
 
@@ -0,0 +1,24 @@
+#include "AutoController.h"
+#include "Aircraft.h"
+
+AutoController::AutoController(std::shared_ptr<Airport> airport)
+  : airport_(airport) {
+}
+
+void AutoController::OnRunwayRequested(std::shared_ptr<Aircraft> aircraft) {
+  auto runway_infos = airport_->GetActiveRunwayInfo();
+  aircraft->AssignTakeOffRunway(runway_infos[next_runway_ % runway_infos.size()]->internal_name);
+  next_runway_++;
+}
+
+void AutoController::OnPushBackRequested(std::shared_ptr<Aircraft> aircraft) {
+  aircraft->PushBackClearanceReceived();
+}
+
+void AutoController::OnTakeOffRequested(std::shared_ptr<Aircraft> aircraft) {
+  aircraft->TakeOffClearanceReceived();
+}
+
+void AutoController::OnManualTaxiResumeAvailable(std::shared_ptr<Aircraft> aircraft) {
+  aircraft->ResumeTaxi();
+}
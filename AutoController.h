@@ -0,0 +1,25 @@
+#ifndef AUTOCONTROLLER_H
+#define AUTOCONTROLLER_H
+
+#include <memory>
+#include "Airport.h"
+#include "SimulationObserver.h"
+
+// Answers every request of the aircraft at once, in place of the player.
+// Used to run the simulation without a window.
+class AutoController : public SimulationObserver {
+  public:
+    AutoController(std::shared_ptr<Airport> airport);
+
+    // Take off runways are assigned in turn from the active ones
+    void OnRunwayRequested(std::shared_ptr<Aircraft> aircraft) override;
+    void OnPushBackRequested(std::shared_ptr<Aircraft> aircraft) override;
+    void OnTakeOffRequested(std::shared_ptr<Aircraft> aircraft) override;
+    void OnManualTaxiResumeAvailable(std::shared_ptr<Aircraft> aircraft) override;
+
+  private:
+    std::shared_ptr<Airport> airport_;
+    int next_runway_ = 0;
+};
+
+#endif // AUTOCONTROLLER_H
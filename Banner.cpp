@@ -1,5 +1,6 @@
 #include "Banner.h"
 #include <TGUI/TGUI.hpp>
+#include <math.h>
 
 Banner::Banner(sf::Vector2f top_left_pos, float width, float height,
                int num_of_rows, int character_size,
@@ -92,7 +93,11 @@ Banner::Banner(sf::Vector2f top_left_pos, float width, float height,
                                               ->setBackgroundColor(
                                                   sf::Color::Green);
                                         }
-                                        aircraft_->manual_taxi_hold_ = !aircraft_->manual_taxi_hold_;
+                                        if (aircraft_->manual_taxi_hold_) {
+                                          aircraft_->ResumeTaxi();
+                                        } else {
+                                          aircraft_->HoldTaxi();
+                                        }
                                       });
     taxi_hold_->setEnabled(false);
     taxi_hold_->setVisible(false);
@@ -145,6 +150,35 @@ void Banner::SetText(std::string text, int line_number) {
   }
 }
 
+void Banner::Update() {
+  // texts are only built again when what they show changes
+  float touch_down_time = aircraft_->GetTouchDownTime();
+  int speed = int(round(aircraft_->GetSpeed()));
+  if (!header_shown_ || touch_down_time != touch_down_time_ ||
+      (touch_down_time < 0 && speed != speed_)) {
+    header_shown_ = true;
+    touch_down_time_ = touch_down_time;
+    speed_ = speed;
+    std::string header = aircraft_->GetName() + "|" + aircraft_->GetModel();
+    if (touch_down_time >= 0) {
+      // the expected landing time, it does not count down
+      std::string clock = ConvertSecondsToHHMMSS(touch_down_time);
+      SetText(header + "|ETA:" + clock.substr(clock.find('\n') + 1), 1);
+    } else {
+      SetText(header + "|SPD:" + std::to_string(speed), 1);
+    }
+  }
+  if (aircraft_->GetStatus() != status_) {
+    status_ = aircraft_->GetStatus();
+    SetText(status_, 2);
+  }
+  std::string taxi_routes = aircraft_->GetTaxiRoutesString();
+  if (taxi_routes != taxi_routes_) {
+    taxi_routes_ = taxi_routes;
+    SetText(taxi_routes_, 3);
+  }
+}
+
 bool Banner::Contains(sf::Vector2f position) {
   auto pos = background_.getPosition();
   return position.x >= pos.x && position.x <= pos.x + width_ &&
@@ -156,9 +190,8 @@ void Banner::RequestRunway() {
 
   runway_selector_->setVisible(true);
   runway_selector_->setEnabled(true);
-  runway_selector_->connect("ItemSelected", [&](){ aircraft_->take_off_runway_assigned_ = true;
-                                                   auto display_name = runway_selector_->getSelectedItem();
-                                                   aircraft_->take_off_runway_ = airport_->GetRunwayInternalName(display_name);
+  runway_selector_->connect("ItemSelected", [&](){ auto display_name = runway_selector_->getSelectedItem();
+                                                   aircraft_->AssignTakeOffRunway(airport_->GetRunwayInternalName(display_name));
                                                    runway_selector_->setVisible(false);
                                                    runway_selector_->setEnabled(false);
                                                  });
@@ -188,7 +221,7 @@ void Banner::RequestTakeOff() {
   lineup_->setText("LINEUP");
   lineup_->connect("pressed", [&](){ if (aircraft_->request_of_take_off_sent_) {
                                          if (!aircraft_->clearance_of_line_up_received_) {
-                                           aircraft_->clearance_of_line_up_received_ = true;
+                                           aircraft_->LineUpClearanceReceived();
                                          }
                                        }
                                        lineup_->setEnabled(false);
@@ -200,8 +233,7 @@ void Banner::RequestTakeOff() {
   takeoff_->setEnabled(true);
   takeoff_->setText("TAKE\nOFF");
   takeoff_->connect("pressed", [&](){ if (aircraft_->request_of_take_off_sent_) {
-                                         aircraft_->clearance_of_line_up_received_ = true;
-                                         aircraft_->clearance_of_take_off_received_ = true;
+                                         aircraft_->TakeOffClearanceReceived();
                                        }
                                        // Need to disable the lineup button
                                        lineup_->setEnabled(false);
@@ -22,6 +22,9 @@ class Banner
     int GetNumOfRows();
 
     void SetText(std::string text, int line_number);
+    // Show speed, status and taxi routes of the aircraft. A request text on
+    // the status line stays until the status of the aircraft changes.
+    void Update();
 
     bool Contains(sf::Vector2f position);
     sf::Vector2f GetPosition();
@@ -54,6 +57,12 @@ class Banner
     sf::Color default_text_color_ = sf::Color::White;
 
     std::shared_ptr<Aircraft> aircraft_;
+    std::string status_ = ""; // last status shown
+    // last header and taxi routes shown
+    bool header_shown_ = false;
+    float touch_down_time_ = -1;
+    int speed_ = 0;
+    std::string taxi_routes_ = "";
 
     // tgui code
     tgui::ScrollablePanel::Ptr parent_panel_;
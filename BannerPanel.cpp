@@ -64,43 +64,61 @@ void BannerPanel::RemoveBanner(std::shared_ptr<Aircraft> aircraft) {
   banners_.erase(banners_.find(aircraft));
 }
 
-void BannerPanel::RequestRunway(std::shared_ptr<Aircraft> aircraft) {
+void BannerPanel::Update() {
+  for (auto& b : banners_) {
+    b.second->Update();
+  }
+}
+
+void BannerPanel::OnAircraftAdded(std::shared_ptr<Aircraft> aircraft) {
+  CreateBanner(aircraft);
+}
+
+void BannerPanel::OnAircraftRemoved(std::shared_ptr<Aircraft> aircraft) {
+  RemoveBanner(aircraft);
+}
+
+void BannerPanel::OnGateRequested(std::shared_ptr<Aircraft> aircraft) {
   if (banners_.count(aircraft) == 1) {
-    banners_[aircraft]->RequestRunway();
+    banners_[aircraft]->RequestGate();
   }
 }
 
-void BannerPanel::RequestPushBack(std::shared_ptr<Aircraft> aircraft) {
+void BannerPanel::OnGateAssigned(std::shared_ptr<Aircraft> aircraft) {
   if (banners_.count(aircraft) == 1) {
-    banners_[aircraft]->RequestPushBack();
+    banners_[aircraft]->DisableGateSelector();
   }
 }
 
-void BannerPanel::RequestTakeOff(std::shared_ptr<Aircraft> aircraft) {
+void BannerPanel::OnRunwayRequested(std::shared_ptr<Aircraft> aircraft) {
   if (banners_.count(aircraft) == 1) {
-    banners_[aircraft]->RequestTakeOff();
+    banners_[aircraft]->RequestRunway();
   }
 }
 
-void BannerPanel::RequestGate(std::shared_ptr<Aircraft> aircraft) {
+void BannerPanel::OnPushBackRequested(std::shared_ptr<Aircraft> aircraft) {
   if (banners_.count(aircraft) == 1) {
-    banners_[aircraft]->RequestGate();
+    banners_[aircraft]->RequestPushBack();
   }
 }
 
-void BannerPanel::TurnOnManualTaxiHold(std::shared_ptr<Aircraft> aircraft) {
+void BannerPanel::OnTakeOffRequested(std::shared_ptr<Aircraft> aircraft) {
   if (banners_.count(aircraft) == 1) {
-    banners_[aircraft]->TurnOnManualTaxiHold();
+    banners_[aircraft]->RequestTakeOff();
   }
 }
 
-void BannerPanel::TurnOffManualTaxiHold(std::shared_ptr<Aircraft> aircraft) {
+void BannerPanel::OnManualTaxiHoldAvailable(std::shared_ptr<Aircraft> aircraft, bool available) {
   if (banners_.count(aircraft) == 1) {
-    banners_[aircraft]->TurnOffManualTaxiHold();
+    if (available) {
+      banners_[aircraft]->TurnOnManualTaxiHold();
+    } else {
+      banners_[aircraft]->TurnOffManualTaxiHold();
+    }
   }
 }
 
-void BannerPanel::TurnOnManualTaxiResume(std::shared_ptr<Aircraft> aircraft) {
+void BannerPanel::OnManualTaxiResumeAvailable(std::shared_ptr<Aircraft> aircraft) {
   if (banners_.count(aircraft) == 1) {
     banners_[aircraft]->TurnOnManualTaxiResume();
   }
@@ -9,11 +9,14 @@
 #include "Banner.h"
 #include "Aircraft.h"
 #include "Airport.h"
+#include "SimulationObserver.h"
 
 class Aircraft;
 class Banner;
 
-class BannerPanel
+// One banner per aircraft, showing what it does and the buttons to answer
+// its requests. Banners are created and removed following the simulation.
+class BannerPanel : public SimulationObserver
 {
   public:
     BannerPanel(sf::Vector2f top_left_pos, float width, float height, sf::RenderWindow* app, sf::Font* font, tgui::Gui* gui, std::shared_ptr<Airport> airport);
@@ -23,16 +26,22 @@ class BannerPanel
     void CreateBanner(std::shared_ptr<Aircraft> aircraft);
     void RemoveBanner(std::shared_ptr<Aircraft> aircraft);
     void Organize();
-    void RequestRunway(std::shared_ptr<Aircraft> aircraft);
-    void RequestPushBack(std::shared_ptr<Aircraft> aircraft);
-    void RequestTakeOff(std::shared_ptr<Aircraft> aircraft);
-    void RequestGate(std::shared_ptr<Aircraft> aircraft);
-    void TurnOnManualTaxiHold(std::shared_ptr<Aircraft> aircraft);
-    void TurnOffManualTaxiHold(std::shared_ptr<Aircraft> aircraft);
-    void TurnOnManualTaxiResume(std::shared_ptr<Aircraft> aircraft);
     std::shared_ptr<Banner> GetBanner(std::shared_ptr<Aircraft> aircraft);
+    // Refresh the banner texts from the aircraft, once per frame
+    void Update();
     void Clear();
 
+    // SimulationObserver
+    void OnAircraftAdded(std::shared_ptr<Aircraft> aircraft) override;
+    void OnAircraftRemoved(std::shared_ptr<Aircraft> aircraft) override;
+    void OnGateRequested(std::shared_ptr<Aircraft> aircraft) override;
+    void OnGateAssigned(std::shared_ptr<Aircraft> aircraft) override;
+    void OnRunwayRequested(std::shared_ptr<Aircraft> aircraft) override;
+    void OnPushBackRequested(std::shared_ptr<Aircraft> aircraft) override;
+    void OnTakeOffRequested(std::shared_ptr<Aircraft> aircraft) override;
+    void OnManualTaxiHoldAvailable(std::shared_ptr<Aircraft> aircraft, bool available) override;
+    void OnManualTaxiResumeAvailable(std::shared_ptr<Aircraft> aircraft) override;
+
     // TGUI code
     tgui::ScrollablePanel::Ptr GetPanel();
 
@@ -0,0 +1,89 @@
+#ifndef BLOCKPOOL_H
+#define BLOCKPOOL_H
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <vector>
+
+// Blocks of one size, kept on a free list once freed and handed out again
+// last freed first, the way a SlotMap reuses its free slots. For objects
+// created and destroyed over and over, like the aircraft of a game: once as
+// many blocks as aircraft at once have been made, spawns take no memory
+// from the heap. The block size is the size of the first request, any
+// other size goes to operator new.
+class BlockPool {
+  public:
+    BlockPool() {}
+    ~BlockPool() {
+      for (void* block : free_blocks_) {
+        ::operator delete(block);
+      }
+    }
+    BlockPool(const BlockPool&) = delete;
+    BlockPool& operator=(const BlockPool&) = delete;
+
+    void* Allocate(std::size_t size) {
+      if (block_size_ == 0) {
+        block_size_ = size;
+      }
+      if (size != block_size_) {
+        return ::operator new(size);
+      }
+      if (free_blocks_.empty()) {
+        num_of_blocks_++;
+        // room to take every block back without growing
+        free_blocks_.reserve(num_of_blocks_);
+        return ::operator new(size);
+      }
+      void* block = free_blocks_.back();
+      free_blocks_.pop_back();
+      return block;
+    }
+
+    void Free(void* block, std::size_t size) {
+      if (size != block_size_) {
+        ::operator delete(block);
+        return;
+      }
+      free_blocks_.push_back(block);
+    }
+
+    // Blocks made so far, in use or free
+    int GetNumOfBlocks() const { return num_of_blocks_; }
+
+  private:
+    std::size_t block_size_ = 0;
+    int num_of_blocks_ = 0;
+    std::vector<void*> free_blocks_;
+};
+
+// Allocator over a BlockPool, for std::allocate_shared: the object and its
+// control block take one block. Every copy shares the pool, so it lives as
+// long as the last object made from it.
+template <typename T>
+class BlockPoolAllocator {
+  public:
+    using value_type = T;
+
+    explicit BlockPoolAllocator(std::shared_ptr<BlockPool> pool) : pool_(std::move(pool)) {}
+    template <typename U>
+    BlockPoolAllocator(const BlockPoolAllocator<U>& other) : pool_(other.pool_) {}
+
+    T* allocate(std::size_t n) {
+      static_assert(alignof(T) <= alignof(std::max_align_t), "blocks are only aligned for max_align_t");
+      return static_cast<T*>(pool_->Allocate(n * sizeof(T)));
+    }
+    void deallocate(T* p, std::size_t n) { pool_->Free(p, n * sizeof(T)); }
+
+    template <typename U>
+    bool operator==(const BlockPoolAllocator<U>& other) const { return pool_ == other.pool_; }
+    template <typename U>
+    bool operator!=(const BlockPoolAllocator<U>& other) const { return pool_ != other.pool_; }
+
+  private:
+    template <typename U> friend class BlockPoolAllocator;
+    std::shared_ptr<BlockPool> pool_;
+};
+
+#endif // BLOCKPOOL_H
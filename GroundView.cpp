@@ -0,0 +1,43 @@
+#include "GroundView.h"
+#include <algorithm>
+
+GroundView::GroundView(sf::RenderWindow* app, sf::Font* font)
+  : app_(app),
+    font_(font) {
+}
+
+void GroundView::Draw() {
+  for (auto& aircraft : aircrafts_) {
+    views_[aircraft]->Draw();
+  }
+}
+
+void GroundView::Clear() {
+  aircrafts_.clear();
+  views_.clear();
+}
+
+void GroundView::OnAircraftAdded(std::shared_ptr<Aircraft> aircraft) {
+  if (views_.count(aircraft) > 0) {
+    return;
+  }
+  aircrafts_.push_back(aircraft);
+  views_[aircraft] = std::make_unique<AircraftView>(aircraft, app_, font_);
+}
+
+void GroundView::OnAircraftRemoved(std::shared_ptr<Aircraft> aircraft) {
+  if (views_.count(aircraft) == 0) {
+    return;
+  }
+  aircrafts_.erase(std::find(aircrafts_.begin(), aircrafts_.end(), aircraft));
+  views_.erase(aircraft);
+}
+
+void GroundView::OnConflict(std::shared_ptr<Aircraft> aircraft, std::shared_ptr<Aircraft> another_aircraft) {
+  if (views_.count(aircraft) == 1) {
+    views_[aircraft]->SetCircleIndicatorColor(sf::Color::Red);
+  }
+  if (views_.count(another_aircraft) == 1) {
+    views_[another_aircraft]->SetCircleIndicatorColor(sf::Color::Red);
+  }
+}
@@ -0,0 +1,35 @@
+#ifndef GROUNDVIEW_H
+#define GROUNDVIEW_H
+
+#include <map>
+#include <memory>
+#include <SFML/Graphics.hpp>
+#include "AircraftView.h"
+#include "SimulationObserver.h"
+
+// Views of the aircraft on the ground, created and removed following the
+// simulation.
+class GroundView : public SimulationObserver
+{
+  public:
+    GroundView(sf::RenderWindow* app, sf::Font* font);
+
+    void Draw();
+    void Clear();
+
+    // SimulationObserver
+    void OnAircraftAdded(std::shared_ptr<Aircraft> aircraft) override;
+    void OnAircraftRemoved(std::shared_ptr<Aircraft> aircraft) override;
+    // Both aircraft are circled in red
+    void OnConflict(std::shared_ptr<Aircraft> aircraft, std::shared_ptr<Aircraft> another_aircraft) override;
+
+  private:
+    sf::RenderWindow* app_;
+    sf::Font* font_;
+
+    // drawn in the order the aircraft were added
+    std::vector<std::shared_ptr<Aircraft>> aircrafts_;
+    std::map<std::shared_ptr<Aircraft>, std::unique_ptr<AircraftView>> views_;
+};
+
+#endif // GROUNDVIEW_H
@@ -0,0 +1,103 @@
+#include "KinematicsTable.h"
+#if defined(__AVX__) || defined(__SSE__)
+#include <immintrin.h>
+#endif
+
+int KinematicsTable::Allocate() {
+  int slot;
+  if (free_slots_.empty()) {
+    slot = Capacity();
+    speed_.push_back(0);
+    acceleration_.push_back(0);
+    route_.push_back(nullptr);
+    direction_on_route_.push_back(true);
+    distance_on_route_.push_back(0);
+    distance_to_next_hold_.push_back(-1);
+    moving_.push_back(0);
+    delta_distance_.push_back(0);
+    in_use_.push_back(true);
+    return slot;
+  }
+  slot = free_slots_.back();
+  free_slots_.pop_back();
+  speed_[slot] = 0;
+  acceleration_[slot] = 0;
+  route_[slot] = nullptr;
+  direction_on_route_[slot] = true;
+  distance_on_route_[slot] = 0;
+  distance_to_next_hold_[slot] = -1;
+  moving_[slot] = 0;
+  delta_distance_[slot] = 0;
+  in_use_[slot] = true;
+  return slot;
+}
+
+void KinematicsTable::Release(int slot) {
+  if (!in_use_[slot]) {
+    return;
+  }
+  in_use_[slot] = false;
+  // an idle slot does not move, whatever pass goes over it
+  speed_[slot] = 0;
+  acceleration_[slot] = 0;
+  moving_[slot] = 0;
+  delta_distance_[slot] = 0;
+  free_slots_.push_back(slot);
+}
+
+void KinematicsTable::Clear() {
+  speed_.clear();
+  acceleration_.clear();
+  route_.clear();
+  direction_on_route_.clear();
+  distance_on_route_.clear();
+  distance_to_next_hold_.clear();
+  moving_.clear();
+  delta_distance_.clear();
+  in_use_.clear();
+  free_slots_.clear();
+  num_of_integrations_ = 0;
+}
+
+void KinematicsTable::Integrate(float dt) {
+  // Every lane does the same operations in the same order as the scalar
+  // loop and multiplying by the moving factor 1 is exact, so the result
+  // does not depend on the instruction set.
+  num_of_integrations_++;
+  int n = Capacity();
+  float* v = speed_.data();
+  const float* a = acceleration_.data();
+  const float* m = moving_.data();
+  float* d = delta_distance_.data();
+  int i = 0;
+#if defined(__AVX__)
+  const __m256 dt8 = _mm256_set1_ps(dt);
+  const __m256 half8 = _mm256_set1_ps(0.5f);
+  for (; i + 8 <= n; i += 8) {
+    __m256 m8 = _mm256_loadu_ps(m + i);
+    __m256 v8 = _mm256_loadu_ps(v + i);
+    __m256 dv8 = _mm256_mul_ps(_mm256_mul_ps(_mm256_loadu_ps(a + i), dt8), m8);
+    __m256 d8 = _mm256_add_ps(v8, _mm256_mul_ps(dv8, half8));
+    _mm256_storeu_ps(d + i, _mm256_mul_ps(_mm256_mul_ps(d8, dt8), m8));
+    _mm256_storeu_ps(v + i, _mm256_add_ps(v8, dv8));
+  }
+#endif
+#if defined(__SSE__)
+  const __m128 dt4 = _mm_set1_ps(dt);
+  const __m128 half4 = _mm_set1_ps(0.5f);
+  for (; i + 4 <= n; i += 4) {
+    __m128 m4 = _mm_loadu_ps(m + i);
+    __m128 v4 = _mm_loadu_ps(v + i);
+    __m128 dv4 = _mm_mul_ps(_mm_mul_ps(_mm_loadu_ps(a + i), dt4), m4);
+    __m128 d4 = _mm_add_ps(v4, _mm_mul_ps(dv4, half4));
+    _mm_storeu_ps(d + i, _mm_mul_ps(_mm_mul_ps(d4, dt4), m4));
+    _mm_storeu_ps(v + i, _mm_add_ps(v4, dv4));
+  }
+#endif
+  for (; i < n; i++) {
+    float dv = a[i] * dt * m[i];
+    float dist = v[i] + dv * 0.5f;
+    d[i] = dist * dt * m[i];
+    v[i] = v[i] + dv;
+  }
+}
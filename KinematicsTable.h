@@ -0,0 +1,64 @@
+#ifndef KINEMATICSTABLE_H
+#define KINEMATICSTABLE_H
+
+#include <vector>
+
+class RouteBase;
+
+// Per tick kinematic state of every aircraft, one array per quantity, so a
+// pass over one quantity of all the aircraft walks contiguous memory. An
+// aircraft keeps its slot from Allocate to Release, a released slot is
+// reused by the next aircraft. Slots are indices, references into the table
+// are only valid until the next Allocate.
+//
+// Integrate advances every moving slot in one pass, with AVX or SSE when the
+// build targets them and plain C++ otherwise. States only set the
+// acceleration, then read the new speed and the distance travelled.
+class KinematicsTable {
+  public:
+    KinematicsTable() {}
+
+    // A slot with every quantity reset: at rest, on no route
+    int Allocate();
+    void Release(int slot);
+    void Clear();
+
+    // Number of slots, in use or free, i.e. the length of every array
+    int Capacity() const { return int(speed_.size()); }
+    bool InUse(int slot) const { return in_use_[slot]; }
+
+    // Only moving slots are integrated, the others keep their speed
+    void SetMoving(int slot, bool moving) { moving_[slot] = moving ? 1 : 0; }
+    // For every moving slot, dv = a * dt, distance = (v + dv / 2) * dt,
+    // v += dv. The distance is 0 for the others.
+    void Integrate(float dt);
+    // Distance travelled by the slot in the last Integrate, meter
+    float GetDeltaDistance(int slot) const { return delta_distance_[slot]; }
+    // Integrate calls since the table was cleared, the ticks run
+    long long GetNumOfIntegrations() const { return num_of_integrations_; }
+
+    float& Speed(int slot) { return speed_[slot]; }                // m/s
+    float& Acceleration(int slot) { return acceleration_[slot]; }  // m/s^2
+    RouteBase*& Route(int slot) { return route_[slot]; }
+    bool GetDirectionOnRoute(int slot) const { return direction_on_route_[slot]; }
+    void SetDirectionOnRoute(int slot, bool direction) { direction_on_route_[slot] = direction; }
+    float& DistanceOnRoute(int slot) { return distance_on_route_[slot]; }
+    // negative when it needs to be computed again
+    float& DistanceToNextHold(int slot) { return distance_to_next_hold_[slot]; }
+
+  private:
+    std::vector<float> speed_;
+    std::vector<float> acceleration_;
+    std::vector<RouteBase*> route_;
+    std::vector<unsigned char> direction_on_route_; // not vector<bool>, one byte each
+    std::vector<float> distance_on_route_;
+    std::vector<float> distance_to_next_hold_;
+    std::vector<float> moving_; // 1 or 0, a factor of the integration step
+    std::vector<float> delta_distance_;
+    long long num_of_integrations_ = 0;
+
+    std::vector<unsigned char> in_use_;
+    std::vector<int> free_slots_;
+};
+
+#endif // KINEMATICSTABLE_H
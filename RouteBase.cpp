@@ -3,13 +3,18 @@
 #include "Utils.h"
 #include <math.h>
 #include <limits.h>
+#include <algorithm>
 
 #include "Aircraft.h"
+#include "TaxiRoute.h"
 
 RouteBase::RouteBase(sf::RenderWindow* app, sf::Font* font)
   : app_(app),
     font_(font) {
-  text_.setFont(*font_);
+  // no font without a window, the text is never shown then
+  if (font_) {
+    text_.setFont(*font_);
+  }
 }
 
 sf::Vector2f RouteBase::GetStartPosition() {
@@ -63,7 +68,7 @@ void RouteBase::AddHoldPoint(HoldPoint hold_point) {
   }
 }
 
-std::vector<HoldPoint> RouteBase::GetHoldPoints(bool direction) {
+const std::vector<HoldPoint>& RouteBase::GetHoldPoints(bool direction) {
   return direction_to_hold_point_[direction];
 }
 
@@ -86,6 +91,14 @@ void RouteBase::ConnectRoute(float my_break_out_distance,
   next_route->InsertBreakpoint({BREAKPOINT_TYPE::IN, this, next_break_in_distance });
 }
 
+const ConnectionInfo* RouteBase::FindConnection(RouteBase* next_route) const {
+  auto iter = connections_.find(next_route->GetName());
+  if (iter == connections_.end()) {
+    return nullptr;
+  }
+  return &iter->second;
+}
+
 void RouteBase::InsertBreakpoint(BreakpointInfo breakpoint_info) {
   breakpoints_.push_back(breakpoint_info);
   std::sort(breakpoints_.begin(), breakpoints_.end(), [](BreakpointInfo a, BreakpointInfo b) { return a.distance_on_current_route < b.distance_on_current_route; });
@@ -98,28 +111,33 @@ void RouteBase::InsertBreakpoint(BreakpointInfo breakpoint_info) {
   // std::cout << std::endl;
 }
 
-void RouteBase::CreateSegments() {
+int RouteBase::CreateSegments(int first_id) {
   // 1. count how many breakpoints, including 0 and end, determine how many segments are required.
   std::vector<float> bp_dist;
   // add zero
   bp_dist.push_back(0);
   for (auto& b : breakpoints_) {
-    if (b.distance_on_current_route != bp_dist.back()) {
+    if (b.distance_on_current_route - bp_dist.back() > SEGMENT_DISTANCE_TOLERANCE) {
       bp_dist.push_back(b.distance_on_current_route);
     }
   }
   // add end
-  if (GetLength() != bp_dist.back()) {
+  if (GetLength() - bp_dist.back() > SEGMENT_DISTANCE_TOLERANCE) {
     bp_dist.push_back(GetLength());
   }
 
   int num_of_segment = bp_dist.size() - 1;
   int seg_name_appendix = 0;
+  segment_bounds_ = bp_dist;
+  positive_segment_index_.assign(num_of_segment, -1);
+  negative_segment_index_.assign(num_of_segment, -1);
   for (int i = 0; i < num_of_segment; i++) {
     // positive segment
     if (one_way_indicator_ >= 0) {
+      positive_segment_index_[i] = segments_.size();
       SegmentInfo seg_info_positive;
       seg_info_positive.route = this;
+      seg_info_positive.matrix_id = first_id + segments_.size();
       seg_info_positive.name = GetName() + "|" + std::to_string(seg_name_appendix) + "+";
       seg_info_positive.length = abs(bp_dist[i] - bp_dist[i + 1]);
       seg_info_positive.direction = true;
@@ -129,8 +147,10 @@ void RouteBase::CreateSegments() {
     }
     // negative segment
     if (one_way_indicator_ <= 0) {
+      negative_segment_index_[i] = segments_.size();
       SegmentInfo seg_info_negative;
       seg_info_negative.route = this;
+      seg_info_negative.matrix_id = first_id + segments_.size();
       seg_info_negative.name = GetName() + "|" + std::to_string(seg_name_appendix) + "-";
       seg_info_negative.length = abs(bp_dist[i] - bp_dist[i + 1]);
       seg_info_negative.direction = false;
@@ -144,72 +164,105 @@ void RouteBase::CreateSegments() {
   // 2. Complete in route connection relationship
   if (one_way_indicator_ == 0) {
     for (int i = 0; i < num_of_segment - 1; i++) {
-      segments_[2 * i].out_segment.push_back(segments_[2 * i + 2].name);
+      segments_[2 * i].out_segment.push_back(segments_[2 * i + 2].matrix_id);
     }
     for (int i = 1; i < num_of_segment; i++) {
-      segments_[2 * i].in_segment.push_back(segments_[2 * i - 2].name);
+      segments_[2 * i].in_segment.push_back(segments_[2 * i - 2].matrix_id);
     }
     for (int i = 0; i < num_of_segment - 1; i++) {
-      segments_[2 * i + 1].in_segment.push_back(segments_[2 * i + 3].name);
+      segments_[2 * i + 1].in_segment.push_back(segments_[2 * i + 3].matrix_id);
     }
     for (int i = 1; i < num_of_segment; i++) {
-      segments_[2 * i + 1].out_segment.push_back(segments_[2 * i - 1].name);
+      segments_[2 * i + 1].out_segment.push_back(segments_[2 * i - 1].matrix_id);
     }
   }
   else if (one_way_indicator_ == 1) {
     for (int i = 0; i < num_of_segment - 1; i++) {
-      segments_[i].out_segment.push_back(segments_[i + 1].name);
+      segments_[i].out_segment.push_back(segments_[i + 1].matrix_id);
     }
     for (int i = 1; i < num_of_segment; i++) {
-      segments_[i].in_segment.push_back(segments_[i - 1].name);
+      segments_[i].in_segment.push_back(segments_[i - 1].matrix_id);
     }
   } else {
     // one_way_indicator_ == -1
     for (int i = 0; i < num_of_segment - 1; i++) {
-      segments_[i].in_segment.push_back(segments_[i + 1].name);
+      segments_[i].in_segment.push_back(segments_[i + 1].matrix_id);
     }
     for (int i = 1; i < num_of_segment; i++) {
-      segments_[i].out_segment.push_back(segments_[i - 1].name);
+      segments_[i].out_segment.push_back(segments_[i - 1].matrix_id);
     }
   }
+  return first_id + segments_.size();
 }
 
-std::string RouteBase::GetBreakoutSegmentName(bool direction, float distance_to_break_out) {
-  for (auto& s : segments_) {
-    if (s.direction == direction && s.end_distance == distance_to_break_out) {
-      return s.name;
-    }
+int RouteBase::FindBoundIndex(float distance) {
+  auto iter = std::lower_bound(segment_bounds_.begin(), segment_bounds_.end(),
+                               distance - SEGMENT_DISTANCE_TOLERANCE);
+  if (iter == segment_bounds_.end() || *iter - distance > SEGMENT_DISTANCE_TOLERANCE) {
+    return -1;
   }
-  std::cout << "GetSegmentName didn't find result." << std::endl;
-  return "";
+  return iter - segment_bounds_.begin();
 }
 
-std::string RouteBase::GetBreakinSegmentName(bool direction, float distance_to_break_in) {
-  for (auto& s : segments_) {
-    if (s.direction == direction && s.start_distance == distance_to_break_in) {
-      return s.name;
-    }
+int RouteBase::GetSegmentIndex(bool direction, int interval) {
+  if (interval < 0 || interval >= int(positive_segment_index_.size())) {
+    return -1;
   }
-  std::cout << "GetSegmentName didn't find result." << std::endl;
-  return "";
+  return direction ? positive_segment_index_[interval] : negative_segment_index_[interval];
 }
 
-std::string RouteBase::GetSegmentName(bool direction, float distance_on_route) {
-  for (auto& s : segments_) {
-    if (s.direction == direction) {
-      if (direction) {
-        if (distance_on_route <= s.end_distance && distance_on_route > s.start_distance) {
-          return s.name;
-        }
-      } else {
-        if (distance_on_route >= s.end_distance && distance_on_route < s.start_distance) {
-          return s.name;
-        }
-      }
-    }
+int RouteBase::FindBreakoutSegmentIndex(bool direction, float distance_to_break_out) {
+  int bound = FindBoundIndex(distance_to_break_out);
+  if (bound < 0) {
+    return -1;
   }
-  std::cout << "Failed to GetSegmentName." << std::endl;
-  return "";
+  // + segments end at their upper bound, - segments at their lower bound
+  return GetSegmentIndex(direction, direction ? bound - 1 : bound);
+}
+
+int RouteBase::FindBreakinSegmentIndex(bool direction, float distance_to_break_in) {
+  int bound = FindBoundIndex(distance_to_break_in);
+  if (bound < 0) {
+    return -1;
+  }
+  return GetSegmentIndex(direction, direction ? bound : bound - 1);
+}
+
+int RouteBase::GetBreakoutSegmentId(bool direction, float distance_to_break_out) {
+  int index = FindBreakoutSegmentIndex(direction, distance_to_break_out);
+  if (index < 0) {
+    std::cout << "GetBreakoutSegmentId didn't find result." << std::endl;
+    return -1;
+  }
+  return segments_[index].matrix_id;
+}
+
+int RouteBase::GetBreakinSegmentId(bool direction, float distance_to_break_in) {
+  int index = FindBreakinSegmentIndex(direction, distance_to_break_in);
+  if (index < 0) {
+    std::cout << "GetBreakinSegmentId didn't find result." << std::endl;
+    return -1;
+  }
+  return segments_[index].matrix_id;
+}
+
+int RouteBase::GetSegmentId(bool direction, float distance_on_route) {
+  // A point within the tolerance of a joint is on the joint, and the joint
+  // belongs to the segment ending there: + segment (start, end], - segment [end, start).
+  int interval;
+  if (direction) {
+    interval = std::lower_bound(segment_bounds_.begin(), segment_bounds_.end(),
+                                distance_on_route - SEGMENT_DISTANCE_TOLERANCE) - segment_bounds_.begin() - 1;
+  } else {
+    interval = std::upper_bound(segment_bounds_.begin(), segment_bounds_.end(),
+                                distance_on_route + SEGMENT_DISTANCE_TOLERANCE) - segment_bounds_.begin() - 1;
+  }
+  int index = GetSegmentIndex(direction, interval);
+  if (index < 0) {
+    std::cout << "Failed to GetSegmentId." << std::endl;
+    return -1;
+  }
+  return segments_[index].matrix_id;
 }
 
 void RouteBase::PopulateIntraRouteConnection() {
@@ -221,164 +274,197 @@ void RouteBase::PopulateIntraRouteConnection() {
       // need to find out peer ConnectionInfo.positive_entering_next_piece
       auto connection_info = b.peer->GetConnectionInfo(GetName());
       bool direction_on_current_route = connection_info.positive_entering_next_piece;
-      int segment_index = -1;
-      for (int i = 0; i < segments_.size(); i++) {
-        if (segments_[i].direction == direction_on_current_route && segments_[i].start_distance == b.distance_on_current_route) {
-          segment_index = i;
-          break;
-        }
-      }
+      int segment_index = FindBreakinSegmentIndex(direction_on_current_route, b.distance_on_current_route);
       if (segment_index < 0) {
         std::cout << "Segment on current route not found(IN type)." << std::endl;
+        continue;
       }
-      // find out peer name and set "in" vec
-      segments_[segment_index].in_segment.push_back(b.peer->GetBreakoutSegmentName(connection_info.direction_allowed_to_enter_next_route, connection_info.distance_to_break_out));
+      // find out peer id and set "in" vec
+      segments_[segment_index].in_segment.push_back(b.peer->GetBreakoutSegmentId(connection_info.direction_allowed_to_enter_next_route, connection_info.distance_to_break_out));
     } else {
       // find out which segment on current route
-      bool direction = connections_[b.peer->GetName()].direction_allowed_to_enter_next_route;
-      int segment_index = -1;
-      for (int i = 0; i < segments_.size(); i++) {
-        if (segments_[i].direction == direction && segments_[i].end_distance == b.distance_on_current_route) {
-          segment_index = i;
-          break;
-        }
-      }
+      auto& connection_info = connections_[b.peer->GetName()];
+      int segment_index = FindBreakoutSegmentIndex(connection_info.direction_allowed_to_enter_next_route, b.distance_on_current_route);
       if (segment_index < 0) {
         std::cout << "Segment on current route not found(OUT type)." << std::endl;
+        continue;
       }
-      //find out peer name and set "out" vec
-      segments_[segment_index].out_segment.push_back(b.peer->GetBreakinSegmentName(connections_[b.peer->GetName()].positive_entering_next_piece, connections_[b.peer->GetName()].distance_to_break_in));
+      //find out peer id and set "out" vec
+      segments_[segment_index].out_segment.push_back(b.peer->GetBreakinSegmentId(connection_info.positive_entering_next_piece, connection_info.distance_to_break_in));
     }
   }
 }
 
-std::vector<SegmentInfo> RouteBase::GetSegments() {
-  return segments_;
-}
-
 void RouteBase::InsertAircraft(std::shared_ptr<Aircraft> aircraft) {
-  aircraft_on_route_.insert(aircraft);
+  UpdateCruiser();
+  float distance = aircraft->GetDistanceOnRoute();
+  auto it = std::upper_bound(aircraft_on_route_.begin(), aircraft_on_route_.end(), distance,
+                             [](float d, const Occupant& o) { return d < o.distance; });
+  aircraft_on_route_.insert(it, {distance, aircraft});
+  OccupancyChanged();
 }
 
 void RouteBase::ClearAircraft(std::shared_ptr<Aircraft> aircraft) {
-  if (aircraft_on_route_.count(aircraft) == 1) {
-    aircraft_on_route_.erase(aircraft);
-  }
-}
-
-// Update aircraft position.
-void RouteBase::ComputePosition(std::shared_ptr<Aircraft> aircraft,
-                                float & dist_at_current,
-                                bool & direction,
-                                const float delta_distance,
-                                RouteBase** current,
-                                std::list<std::string>& taxi_routes) {
-  if (taxi_routes.empty()) return;
-  // 1. compute new distantce
-  float new_dist = dist_at_current + (direction ? delta_distance :
-                                      -delta_distance);
-  // 2. determine bound
-  std::string second_route = "";
-  ConnectionInfo* info = (taxi_routes.size() > 1 ? &connections_[*std::next(
-                            taxi_routes.begin())] : nullptr);
-  float bound = info ? info->distance_to_break_out : (direction ?
-      this->GetLength() : 0);
-
-  // 3. update dist_at_current
-  if (direction ? (new_dist < bound) : (new_dist > bound)) {
-    // A. no transition
-    dist_at_current = new_dist;
+  UpdateCruiser();
+  int i = FindOccupant(aircraft.get(), aircraft->GetDistanceOnRoute());
+  if (i >= 0) {
+    aircraft_on_route_.erase(aircraft_on_route_.begin() + i);
+    OccupancyChanged();
+  }
+}
+
+void RouteBase::Watch(Aircraft* aircraft) {
+  if (std::find(watchers_.begin(), watchers_.end(), aircraft) == watchers_.end()) {
+    watchers_.push_back(aircraft);
+  }
+}
+
+void RouteBase::Unwatch(Aircraft* aircraft) {
+  auto it = std::find(watchers_.begin(), watchers_.end(), aircraft);
+  if (it != watchers_.end()) {
+    *it = watchers_.back();
+    watchers_.pop_back();
+  }
+}
+
+void RouteBase::OccupancyChanged() {
+  occupancy_version_++;
+  // told once, a watcher watches again when it cruises again
+  for (Aircraft* watcher : watchers_) {
+    watcher->OnTrafficAheadChanged();
+  }
+  watchers_.clear();
+}
+
+void RouteBase::UpdateCruiser() {
+  if (!cruiser_) {
+    return;
+  }
+  for (Occupant& occupant : aircraft_on_route_) {
+    if (occupant.aircraft.get() == cruiser_) {
+      occupant.distance = cruiser_->GetDistanceOnRoute();
+    }
+  }
+}
+
+void RouteBase::MoveAircraft(Aircraft* aircraft, float old_distance, float new_distance) {
+  if (aircraft != cruiser_) {
+    UpdateCruiser();
+  }
+  int i = FindOccupant(aircraft, old_distance);
+  if (i < 0) {
+    return;
+  }
+  aircraft_on_route_[i].distance = new_distance;
+  // a tick moves an aircraft by a few meters, past a neighbour at most
+  while (i + 1 < int(aircraft_on_route_.size()) && aircraft_on_route_[i + 1].distance < new_distance) {
+    std::swap(aircraft_on_route_[i], aircraft_on_route_[i + 1]);
+    i++;
+  }
+  while (i > 0 && aircraft_on_route_[i - 1].distance > new_distance) {
+    std::swap(aircraft_on_route_[i], aircraft_on_route_[i - 1]);
+    i--;
+  }
+}
+
+int RouteBase::FindOccupant(const Aircraft* aircraft, float distance) const {
+  auto it = std::lower_bound(aircraft_on_route_.begin(), aircraft_on_route_.end(), distance,
+                             [](const Occupant& o, float d) { return o.distance < d; });
+  for (; it != aircraft_on_route_.end() && it->distance == distance; it++) {
+    if (it->aircraft.get() == aircraft) {
+      return it - aircraft_on_route_.begin();
+    }
+  }
+  // not where it was last told to be, look everywhere
+  for (int i = 0; i < int(aircraft_on_route_.size()); i++) {
+    if (aircraft_on_route_[i].aircraft.get() == aircraft) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+const RouteBase::Occupant* RouteBase::ClosestOccupantBetween(const Aircraft* aircraft,
+                                                             float dist, float end_dist,
+                                                             float& distance) const {
+  if (cruiser_ && aircraft_on_route_.size() == 1) {
+    // the cruiser alone, its entry is where it started
+    const Occupant& occupant = aircraft_on_route_[0];
+    distance = cruiser_->GetDistanceOnRoute();
+    bool between = end_dist >= dist ? (distance >= dist && distance <= end_dist) :
+                                      (distance <= dist && distance >= end_dist);
+    return between && occupant.aircraft.get() != aircraft ? &occupant : nullptr;
+  }
+  if (end_dist >= dist) {
+    // first one at or after dist
+    auto it = std::lower_bound(aircraft_on_route_.begin(), aircraft_on_route_.end(), dist,
+                               [](const Occupant& o, float d) { return o.distance < d; });
+    for (; it != aircraft_on_route_.end() && it->distance <= end_dist; it++) {
+      if (it->aircraft.get() != aircraft) {
+        distance = it->distance;
+        return &*it;
+      }
+    }
   } else {
-    // B. transition needed
-    if (taxi_routes.size() == 1) {
-      // Transition needed but only the current route is in the list,
-      // no further routes. So stop at the end of the current route.
-      taxi_routes.pop_front();
-      dist_at_current = bound;
-    } else {
-      // The taxi_routes size must be > 1 here. Return empty at begining,
-      // ==1 in the above if.
-      DEBUG("Transition computed", 0);
-      // Check if the current taxi direction is allowed to enter the next route
-      if (info && (info->direction_allowed_to_enter_next_route != direction)) {
-        std::cerr << "Taxi direction "
-                  << (direction ? "Positive" : "Negative")
-                  << " of " << taxi_routes.front() << " is not allowed to enter "
-                  << *std::next(taxi_routes.begin())
-                  << std::endl;
-        return;
+    // last one at or before dist
+    auto it = std::upper_bound(aircraft_on_route_.begin(), aircraft_on_route_.end(), dist,
+                               [](float d, const Occupant& o) { return d < o.distance; });
+    while (it != aircraft_on_route_.begin()) {
+      it--;
+      if (it->distance < end_dist) {
+        break;
+      }
+      if (it->aircraft.get() != aircraft) {
+        distance = it->distance;
+        return &*it;
       }
-      // 3.2.1 determine break in distance
-      dist_at_current = info->distance_to_break_in;
-      new_dist = direction ? (new_dist - bound) : (bound - new_dist);
-      // 3.2.2 before update *current, free the aircraft and add it to new route
-      (*current)->ClearAircraft(aircraft);
-
-      // 3.2.3 call next piece's compute function
-      *current = info->next_piece;
-      (*current)->InsertAircraft(aircraft);
-      taxi_routes.pop_front();
-      direction = info->positive_entering_next_piece;
-      info->next_piece->ComputePosition(aircraft, dist_at_current, direction, new_dist, current,
-                                        taxi_routes);
     }
   }
+  return nullptr;
 }
 
 std::shared_ptr<Aircraft> RouteBase::ClosestAircraftInWay(
                             std::shared_ptr<Aircraft> aircraft,
                             float& search_dist,
-                            bool direction,
-                            float dist) {
-  std::shared_ptr<Aircraft> aircraft_in_the_way = nullptr;
-  const std::list<std::string> taxi_routes = aircraft->GetTaxiRoutes();
-  float target_distance_from_me = 0;
+                            bool& direction,
+                            float dist,
+                            std::vector<RouteBase*>* routes_searched) {
+  TaxiRouteView taxi_routes = aircraft->GetTaxiRoutes();
   float res = 0;
-  if (taxi_routes.empty()) {
+  if (taxi_routes.Empty()) {
     std::cerr << "Taxi routes shouldn't be empty" << std::endl;
   }
   RouteBase* current_route = this;
   float end_dist;
-  float min_dist = search_dist;
-
-  ConnectionInfo info;
-  for (auto iter = taxi_routes.begin(); iter != taxi_routes.end(); ++iter) {
-    std::string next_route_string = std::next(iter)!=taxi_routes.end()? *(std::next(iter)) : "";
-    ConnectionInfo info = current_route->GetConnectionInfo(next_route_string);
-    end_dist = (std::next(iter) != taxi_routes.end()) ? info.distance_to_break_out : (direction ? current_route->GetLength() : 0);
-    float low_bound = direction ? std::min(dist, end_dist) : std::max(dist, end_dist);
-    float up_bound = direction ? std::max(dist, end_dist) : std::min(dist, end_dist);
-
-    // check if current route has aircraft, find the closest one. if not, update res. if res<0 return nullptr.
-    auto vec = current_route->GetAircraftOnRoute();
-    if (!vec.empty()) {
-      for (auto& a : vec) {
-        if (a == aircraft) {
-          continue;
-        }
-        // here we need to use max and min to fix a bug for travel on the negative direction
-        if (a->GetDistanceOnRoute() <= std::max(up_bound, low_bound) && a->GetDistanceOnRoute() >= std::min(low_bound, up_bound)) {
-          target_distance_from_me = abs(a->GetDistanceOnRoute() - dist) + res;
-          if (target_distance_from_me < min_dist) {
-            min_dist = target_distance_from_me;
-            aircraft_in_the_way = a;
-          }
-        }
-      }
-      if (aircraft_in_the_way != nullptr) {
-        search_dist = min_dist;
-        return aircraft_in_the_way;
+
+  for (int i = 0; i < taxi_routes.Size(); i++) {
+    const ConnectionInfo* info = taxi_routes.Hop(i);
+    end_dist = info ? info->distance_to_break_out : (direction ? current_route->GetLength() : 0);
+    if (routes_searched) {
+      routes_searched->push_back(current_route);
+    }
+
+    // the closest aircraft on the part of the route ahead, if any
+    float closest_distance = 0;
+    const Occupant* closest = current_route->ClosestOccupantBetween(aircraft.get(), dist, end_dist,
+                                                                    closest_distance);
+    if (closest) {
+      float target_distance_from_me = abs(closest_distance - dist) + res;
+      if (target_distance_from_me < search_dist) {
+        search_dist = target_distance_from_me;
+        return closest->aircraft;
       }
+      return nullptr;
     }
 
     res += abs(end_dist - dist);
     if (res >= search_dist) {
       return nullptr;
     } else {
-      if (std::next(iter) != taxi_routes.end()) {
-        dist = info.distance_to_break_in;
-        direction = info.positive_entering_next_piece;
-        current_route = info.next_piece;
+      if (info) {
+        dist = info->distance_to_break_in;
+        direction = info->positive_entering_next_piece;
+        current_route = info->next_piece;
       } else {
         return nullptr;
       }
@@ -389,64 +475,17 @@ std::shared_ptr<Aircraft> RouteBase::ClosestAircraftInWay(
 
 std::vector<std::shared_ptr<Aircraft>> RouteBase::GetAircraftOnRoute() {
   std::vector<std::shared_ptr<Aircraft>> res;
-  for (auto aircraft : aircraft_on_route_) {
-    res.push_back(aircraft);
-  }
-  return res;
-}
-
-float RouteBase::GetDistanceToNextHold(const std::list<std::string>& taxi_routes,
-                                const float& distance_on_route,
-                                const bool& direction_on_route,
-                                HoldPointType& next_hold_type) {
-  float res = 0; // output
-  if (taxi_routes.empty()) {
-    std::cerr << "Taxi routes shouldn't be empty" << std::endl;
-  }
-  RouteBase* current_route = this;
-  bool direction = direction_on_route;
-  float dist = distance_on_route;
-  float end_dist;
-  ConnectionInfo info;
-  for (auto iter = taxi_routes.begin(); iter != taxi_routes.end(); ++iter) {
-    // determine range(end_dist)
-    std::string next_route_string = std::next(iter)!=taxi_routes.end()? *(std::next(iter)) : "";
-    ConnectionInfo info = current_route->GetConnectionInfo(next_route_string);
-    end_dist = (std::next(iter) != taxi_routes.end()) ? info.distance_to_break_out : (direction ? current_route->GetLength() : 0);
-    float low_bound = direction ? std::min(dist, end_dist) : std::max(dist, end_dist);
-    float up_bound = direction ? std::max(dist, end_dist) : std::min(dist, end_dist);
-    // std::cout << "In the loop: lowb " << low_bound << " upb " << up_bound << std::endl;
-    auto vec = current_route->GetHoldPoints(direction);
-
-    // If there are multiple hold points on the same route, need to find the closest one.
-    float min_dist_to_hold_point_on_route = INT_MAX;
-    for (auto& p : vec) {
-      if (p.distance_on_route <= std::max(up_bound, low_bound) && p.distance_on_route >= std::min(low_bound, up_bound)) {
-        if (abs(dist-p.distance_on_route) < min_dist_to_hold_point_on_route) {
-          next_hold_type = p.type;
-          min_dist_to_hold_point_on_route = abs(dist-p.distance_on_route);
-        }
-      }
-    }
-    if (min_dist_to_hold_point_on_route < INT_MAX) {
-      return res + min_dist_to_hold_point_on_route;
-    }
-    res += abs(end_dist - dist);
-
-    if (std::next(iter) != taxi_routes.end()) {
-      dist = info.distance_to_break_in;
-      direction = info.positive_entering_next_piece;
-      current_route = info.next_piece;
-    }
-  }
-  if (res == 0) {
-    next_hold_type = HoldPointType::NOTSET;
+  for (auto& occupant : aircraft_on_route_) {
+    res.push_back(occupant.aircraft);
   }
   return res;
 }
 
 void RouteBase::Reset() {
   aircraft_on_route_.clear();
+  occupancy_version_++;
+  cruiser_ = nullptr;
+  watchers_.clear();
 }
 
 bool RouteBase::AllowTravelInDirection(bool direction) {
@@ -603,7 +642,9 @@ void Runway::InitializeDisplayDetails(LineParameter param, RunwayDetailsParam de
   int degree = runway_info_[0]->runway_number;
   int degree_2 = runway_info_[1]->runway_number;
   sf::Text t1, t2, l1, l2;
-  t1.setFont(*font_);
+  if (font_) {
+    t1.setFont(*font_);
+  }
   t1.setCharacterSize(details_param.runway_number_character_size);
   t2 = t1;
   l1 = t1;
@@ -815,7 +856,9 @@ Arcway::Arcway(ArcParameter param, sf::RenderWindow* app, sf::Font* font)
 }
 
 void Arcway::SetupText() {
-  text_.setFont(*font_);
+  if (font_) {
+    text_.setFont(*font_);
+  }
   text_.setString(name_);
   text_.setCharacterSize(50);
   text_.setFillColor(sf::Color::Red);
@@ -857,7 +900,9 @@ void Gate::Draw(bool display_text) {
 }
 
 void Gate::SetupText() {
-  text_.setFont(*font_);
+  if (font_) {
+    text_.setFont(*font_);
+  }
   text_.setString(name_);
   text_.setCharacterSize(30);
   text_.setFillColor(sf::Color::Green);
@@ -10,6 +10,9 @@
 
 #define PI 3.1415926536
 
+// Two distances on a route closer than this (meter) are the same breakpoint
+#define SEGMENT_DISTANCE_TOLERANCE 0.01
+
 #define debugging_enabled 0
 
 #define DEBUG(x, my_switch) do { \
@@ -151,8 +154,9 @@ struct ArcParameter {
     // provide ability finding back
     RouteBase* route;
     // unique name: route_name + on_route_id + "+/-", e.g., R1s1, R1 is route name, s1 is segment name on the route, "+/-" is segment travel direction
+    // only used for display and debug output, segments are referred to by matrix_id
     std::string name;
-    // unique id in matrix, will be signed by the Airport class
+    // unique dense id over the whole airport, assigned by CreateSegments
     int matrix_id;
     // Length of this segment
     float length;
@@ -162,27 +166,28 @@ struct ArcParameter {
     float start_distance;
     // end distance
     float end_distance;
-    // In vector
-    std::vector<std::string> in_segment;
-    // Out vector
-    std::vector<std::string> out_segment;
+    // In vector, matrix ids of the segments that can enter this one
+    std::vector<int> in_segment;
+    // Out vector, matrix ids of the segments this one can enter
+    std::vector<int> out_segment;
   };
 
-class RouteBase {
-  struct ConnectionInfo {
-    // Direction on the current route that is allowed to enter the next route
-    bool direction_allowed_to_enter_next_route;
-    // T breaks out at 500, when entering B, at B 60.
-    float distance_to_break_out;
-    // Pointer of next piece.
-    RouteBase* next_piece;
-    // When entering the next piece, the distance at next piece.
-    float distance_to_break_in;
-    // True-increase distance when entering next piece,
-    // False-decrease distance when entering next piece.
-    bool positive_entering_next_piece;
-  };
+// How a route is left to enter the next one
+struct ConnectionInfo {
+  // Direction on the current route that is allowed to enter the next route
+  bool direction_allowed_to_enter_next_route;
+  // T breaks out at 500, when entering B, at B 60.
+  float distance_to_break_out;
+  // Pointer of next piece.
+  RouteBase* next_piece;
+  // When entering the next piece, the distance at next piece.
+  float distance_to_break_in;
+  // True-increase distance when entering next piece,
+  // False-decrease distance when entering next piece.
+  bool positive_entering_next_piece;
+};
 
+class RouteBase {
   enum BREAKPOINT_TYPE {
     IN,
     OUT
@@ -199,6 +204,12 @@ class RouteBase {
     float distance_on_current_route;
   };
 
+  // An aircraft on the route and its distance on route when last told
+  struct Occupant {
+    float distance;
+    std::shared_ptr<Aircraft> aircraft;
+  };
+
   public:
     RouteBase(sf::RenderWindow* app, sf::Font* font);
 
@@ -208,15 +219,7 @@ class RouteBase {
     // Return the total length that an aircraft can travel of this route piece
     float GetLength() { return length_; }
 
-    // Update aircraft position
-    void ComputePosition(std::shared_ptr<Aircraft> aircraft,
-                         float& dist_at_current,
-                         bool& direction,
-                         const float delta_distance,
-                         RouteBase** current,
-                         std::list<std::string>& taxi_routes);
-
-    std::string GetName() { return name_; }
+    const std::string& GetName() const { return name_; }
     RouteType GetRouteType() { return route_type_; }
 
     float GetRotation(float dis, bool direction);
@@ -229,6 +232,9 @@ class RouteBase {
       return connections_[route];
     }
 
+    // Connection to next_route, nullptr if next_route can not be entered from here
+    const ConnectionInfo* FindConnection(RouteBase* next_route) const;
+
     float GetTaxiSpeedLimit() { return taxi_speed_limit_; }
 
     virtual void Draw(bool display_text) = 0;
@@ -239,23 +245,41 @@ class RouteBase {
                       float next_break_in_distance,
                       bool positive_entering_next_route);
 
-    float GetDistanceToNextHold(const std::list<std::string>& taxi_routes,
-                                const float& distance_on_route,
-                                const bool& direction_on_route,
-                                /*output*/HoldPointType& next_hold_type);
-
     void AddHoldPoint(HoldPoint hold_point);
-    std::vector<HoldPoint> GetHoldPoints(bool direction);
+    const std::vector<HoldPoint>& GetHoldPoints(bool direction);
 
+    // Occupants are kept sorted by distance on route. Insert reads the
+    // distance of the aircraft, set it before.
     void InsertAircraft(std::shared_ptr<Aircraft> aircraft);
     void ClearAircraft(std::shared_ptr<Aircraft> aircraft);
-
+    // The aircraft moved on this route from old_distance to new_distance.
+    // A small move only swaps it with its neighbours.
+    void MoveAircraft(Aircraft* aircraft, float old_distance, float new_distance);
+    // Changes whenever an aircraft enters or leaves the route, not when one
+    // moves on it
+    int GetOccupancyVersion() const { return occupancy_version_; }
+    int GetNumOfOccupants() const { return int(aircraft_on_route_.size()); }
+    // A cruising aircraft is alone on its route when it starts, its entry is
+    // not moved meanwhile. The entry is brought up to date before another
+    // aircraft changes the route, searches read where it is now.
+    void SetCruiser(Aircraft* aircraft) { cruiser_ = aircraft; }
+    // The aircraft is told once the occupancy version changes, see
+    // Aircraft::OnTrafficAheadChanged
+    void Watch(Aircraft* aircraft);
+    void Unwatch(Aircraft* aircraft);
+
+    // Closest aircraft along the taxi routes of aircraft, from dist on this
+    // route, closer than search_dist. search_dist is set to its distance.
+    // routes_searched, if given, gets the routes looked at in order, and
+    // direction the direction on the last of them.
     std::shared_ptr<Aircraft> ClosestAircraftInWay(
                             std::shared_ptr<Aircraft> aircraft,
                             float& search_dist,
-                            bool direction,
-                            float dist);
+                            bool& direction,
+                            float dist,
+                            std::vector<RouteBase*>* routes_searched = nullptr);
 
+    // In the order of distance on route
     std::vector<std::shared_ptr<Aircraft>> GetAircraftOnRoute();
 
     virtual void Reset();
@@ -266,21 +290,25 @@ class RouteBase {
 
     void InsertBreakpoint(BreakpointInfo breakpoint_info);
 
-    void CreateSegments();
+    // Split the route into segments at the breakpoints and give them
+    // consecutive matrix ids starting from first_id. Returns the next free id.
+    int CreateSegments(int first_id);
 
-    std::string GetBreakoutSegmentName(bool direction, float distance_to_break_out);
+    // Matrix id of the segment ending / starting at the distance, -1 if none
+    int GetBreakoutSegmentId(bool direction, float distance_to_break_out);
 
-    std::string GetBreakinSegmentName(bool direction, float distance_to_break_in);
+    int GetBreakinSegmentId(bool direction, float distance_to_break_in);
 
     // Based on ConnectionInfo and BREAKPOINT::IN, set intra-route
     // in, out info on SegmentInfo
     void PopulateIntraRouteConnection();
 
+    // Matrix id of the segment containing the point, -1 if none.
     // If the point is on joint of two consecutive segments,
     // return the upstream one.
-    std::string GetSegmentName(bool direction, float distance_on_route);
+    int GetSegmentId(bool direction, float distance_on_route);
 
-    std::vector<SegmentInfo> GetSegments();
+    const std::vector<SegmentInfo>& GetSegments() const { return segments_; }
 
     // get the next route ptr breaking out at input distance. used to find the next route after push back done.
     std::vector<RouteBase*> GetConnectedRouteBreakOutAt(float distance);
@@ -290,6 +318,32 @@ class RouteBase {
     // Setup route element text for display
     virtual void SetupText() = 0;
 
+  private:
+    // Index in segment_bounds_ of the breakpoint at distance, -1 if none.
+    // Binary search, O(log n).
+    int FindBoundIndex(float distance);
+
+    // Index in segments_ of the segment on interval [segment_bounds_[interval],
+    // segment_bounds_[interval + 1]] in direction, -1 if none.
+    int GetSegmentIndex(bool direction, int interval);
+
+    // Index in segments_ of the segment ending / starting at distance, -1 if none
+    int FindBreakoutSegmentIndex(bool direction, float distance_to_break_out);
+    int FindBreakinSegmentIndex(bool direction, float distance_to_break_in);
+
+    // Index in aircraft_on_route_ of the aircraft, found around its last
+    // known distance, -1 if it is not on the route
+    int FindOccupant(const Aircraft* aircraft, float distance) const;
+    // Occupant other than aircraft closest to dist, from dist to end_dist
+    // whichever way they are, nullptr if there is none, distance is set to
+    // where it is. Binary search.
+    const Occupant* ClosestOccupantBetween(const Aircraft* aircraft, float dist, float end_dist,
+                                           float& distance) const;
+    // Bring the entry of the cruiser up to date, before the list changes
+    void UpdateCruiser();
+    // Bump the occupancy version and tell the watchers
+    void OccupancyChanged();
+
   protected:
     sf::RenderWindow* app_;
     sf::Font* font_;
@@ -321,8 +375,11 @@ class RouteBase {
     std::unordered_map<bool, std::vector<HoldPoint>> direction_to_hold_point_;
     std::vector<sf::RectangleShape> hold_point_rects_;
 
-    // store all the aircrafts currently on this route.
-    std::unordered_set<std::shared_ptr<Aircraft>> aircraft_on_route_;
+    // store all the aircrafts currently on this route, sorted by distance
+    std::vector<Occupant> aircraft_on_route_;
+    int occupancy_version_ = 0;
+    Aircraft* cruiser_ = nullptr;
+    std::vector<Aircraft*> watchers_;
 
     // one way indicator. 0:both ways, 1:+, -1:-
     int one_way_indicator_ = 0;
@@ -333,6 +390,14 @@ class RouteBase {
     // SegmentInfo, seg1+, seg1-, seg2+, seg2-, ...
     // for one-way route, still in this order seg1+, seg2+, ... or seg1-, seg2-, ...
     std::vector<SegmentInfo> segments_;
+
+    // Distances of the segment ends, 0 and route length included, sorted increasingly.
+    // Segment interval i is [segment_bounds_[i], segment_bounds_[i + 1]].
+    std::vector<float> segment_bounds_;
+    // Index in segments_ of the + / - segment of every interval, -1 if the
+    // direction is not allowed.
+    std::vector<int> positive_segment_index_;
+    std::vector<int> negative_segment_index_;
 };
 
 class Arcway : public RouteBase {
@@ -0,0 +1,430 @@
+#include "Simulation.h"
+#include <algorithm>
+#include <iostream>
+
+Simulation::Simulation(std::shared_ptr<Airport> airport, unsigned int seed,
+                       float tick, int max_ticks_per_advance)
+  : airport_(airport),
+    seed_(seed),
+    rng_(seed),
+    tick_(tick),
+    max_ticks_per_advance_(max_ticks_per_advance),
+    aircraft_pool_(std::make_shared<BlockPool>()),
+    workers_(std::make_unique<WorkerPool>(1)),
+    conflict_grid_(1) {
+  // Add an aircraft calling name pool
+  calling_name_pool_ = {
+      /*United*/ "UAL",  /*American*/ "AAL", /*Southwest*/ "SWA",
+      /*JetBlue*/ "JBU", /*Alaska*/ "ASA",   /*Delta*/ "DAL"};
+
+  // Add aircraft identification pool
+  aircraft_identification_pool_ = {
+      {"", "A320", "A320neo_CFM_AIB_VT.png", 37.57, 35.8, -3.0},
+      {"", "A350", "A350-1000_T.png", 73.79, 64.75, -3.0},
+      {"", "A380", "A380.png", 72.85, 79.88, -3.0}};
+  ScheduleTraffic();
+}
+
+Simulation::~Simulation() {
+}
+
+void Simulation::AddObserver(SimulationObserver* observer) {
+  observers_.push_back(observer);
+}
+
+SlotHandle Simulation::AddAircraft(AircraftIdentification id,
+                                   std::shared_ptr<RunwayInfo> landing_runway_info) {
+  auto aircraft = std::allocate_shared<Aircraft>(BlockPoolAllocator<Aircraft>(aircraft_pool_), id, airport_,
+                                                 &rng_, &kinematics_, kinematics_.Allocate());
+  aircraft->SetLandingRunwayInfo(landing_runway_info);
+  aircraft->SetTouchDownTime(GetTime() + BEFORE_LANDING_INTERVAL);
+  if (aircraft->GetRadius() > max_aircraft_radius_) {
+    // empties the grid, CheckConflicts only puts the awake aircraft back,
+    // the dormant ones would be missed until they wake
+    max_aircraft_radius_ = aircraft->GetRadius();
+    conflict_grid_.SetCellSize(2 * max_aircraft_radius_);
+    for (auto& entry : aircrafts_) {
+      if (entry.aircraft->IsActive()) {
+        conflict_grid_.Update(entry.aircraft->GetSlot(), entry.aircraft->GetPosition());
+      }
+    }
+  }
+  // observers know the aircraft before its first request
+  OnAircraftAdded(aircraft);
+  aircraft->SetWakeRequests(&wake_requests_);
+  SlotHandle handle = aircrafts_.Insert({aircraft, StateMachine(aircraft, this)});
+  index_of_slot_.resize(kinematics_.Capacity());
+  index_of_slot_[aircraft->GetSlot()] = aircrafts_.Size() - 1;
+  SwapAircrafts(aircrafts_.Size() - 1, num_of_awake_);
+  num_of_awake_++;
+  return handle;
+}
+
+void Simulation::GenerateTraffic() {
+  int random_number = RandomInt(rng_, 1, 6);
+  int aircraft_id_pool_index = random_number <= 4 ? 0 : (random_number == 5 ? 1 : 2);
+  AircraftIdentification id =
+      aircraft_identification_pool_[aircraft_id_pool_index];
+  id.name = calling_name_pool_[RandomInt(rng_, 0, calling_name_pool_.size() - 1)];
+  id.name += std::to_string(RandomInt(rng_, 101, 999));
+  auto runway_infos = airport_->GetActiveRunwayInfo();
+  int random_runway_number = RandomInt(rng_, 0, int(runway_infos.size()) - 1);
+  AddAircraft(id, runway_infos[random_runway_number]);
+}
+
+void Simulation::SetAutoGenerateTraffic(bool is_auto_generate_traffic) {
+  is_auto_generate_traffic_ = is_auto_generate_traffic;
+  if (is_auto_generate_traffic_) {
+    ScheduleTraffic();
+  }
+}
+
+void Simulation::SetNumOfThreads(int num_of_threads) {
+  workers_ = std::make_unique<WorkerPool>(num_of_threads);
+}
+
+void Simulation::SetMaxWallTimePerAdvance(float seconds) {
+  max_wall_time_per_advance_ = seconds;
+}
+
+bool Simulation::IsOverWallTime(std::chrono::steady_clock::time_point start) const {
+  if (max_wall_time_per_advance_ <= 0) {
+    return false;
+  }
+  std::chrono::duration<float> wall_time = std::chrono::steady_clock::now() - start;
+  return wall_time.count() >= max_wall_time_per_advance_;
+}
+
+int Simulation::Advance(float elapsed) {
+  accumulator_ += elapsed;
+  auto start = std::chrono::steady_clock::now();
+  int n = 0;
+  while (accumulator_ >= tick_ && n < max_ticks_per_advance_ && !IsOverWallTime(start)) {
+    Step();
+    accumulator_ -= tick_;
+    n++;
+  }
+  if (accumulator_ >= tick_) {
+    accumulator_ = 0;
+  }
+  return n;
+}
+
+bool Simulation::Warp(int max_ticks) {
+  controller_asked_ = false;
+  auto start = std::chrono::steady_clock::now();
+  for (int n = 0; n < max_ticks && !is_game_over_ && !IsOverWallTime(start); n++) {
+    Step();
+    if (controller_asked_) {
+      return true;
+    }
+  }
+  return is_game_over_;
+}
+
+void Simulation::Step() {
+  if (is_game_over_) {
+    return;
+  }
+  num_of_ticks_++;
+  // told something since the last tick, an awake one stops cruising
+  for (int slot : wake_requests_) {
+    int i = index_of_slot_[slot];
+    if (i >= aircrafts_.Size() || aircrafts_.At(i).aircraft->GetSlot() != slot) {
+      continue;
+    }
+    if (aircrafts_.At(i).asleep) {
+      Wake(i);
+    } else {
+      aircrafts_.At(i).state_machine.Interrupt();
+    }
+  }
+  wake_requests_.clear();
+  timers_due_.clear();
+  timers_.Tick(timers_due_);
+  for (SlotHandle handle : timers_due_) {
+    if (handle.slot < 0) {
+      if (is_auto_generate_traffic_ && num_of_ticks_ == traffic_tick_) {
+        GenerateTraffic();
+        last_generate_traffic_time_ = GetTime();
+        auto_generate_traffic_interval_ = auto_generate_traffic_interval_ + RandomInt(rng_, 0, 59);
+        ScheduleTraffic();
+      }
+    } else if (SimulatedAircraft* entry = aircrafts_.Get(handle)) {
+      // a timer of an aircraft woken or interrupted earlier is stale
+      if (entry->asleep && entry->wake_tick == num_of_ticks_) {
+        Wake(index_of_slot_[entry->aircraft->GetSlot()]);
+      } else if (!entry->asleep && entry->cruise_end_tick == num_of_ticks_) {
+        entry->state_machine.Interrupt();
+      }
+    }
+  }
+
+  // 1. every awake aircraft decides on the state the last tick left, none
+  // of them changes what the others read, so they can run in parallel
+  int n = num_of_awake_;
+  if (n >= MIN_AIRCRAFTS_TO_DECIDE_IN_PARALLEL) {
+    workers_->ParallelFor(n, [this](int i) { aircrafts_.At(i).state_machine.Decide(tick_); });
+  } else {
+    for (int i = 0; i < n; i++) {
+      aircrafts_.At(i).state_machine.Decide(tick_);
+    }
+  }
+  // 2. transitions in order, then integrate every moving aircraft at once
+  // and move them, route changes included, in order too
+  for (int i = 0; i < n; i++) {
+    aircrafts_.At(i).state_machine.Commit();
+    SleepIfAsked(i);
+  }
+  kinematics_.Integrate(tick_);
+  for (int i = 0; i < n; i++) {
+    if (!aircrafts_.At(i).asleep) {
+      aircrafts_.At(i).state_machine.Move(tick_);
+      CruiseIfAsked(i);
+    }
+  }
+  PartitionAsleep();
+  RemoveDeletedAircrafts();
+  CheckConflicts();
+}
+
+void Simulation::SleepIfAsked(int i) {
+  SimulatedAircraft& entry = aircrafts_.At(i);
+  int ticks = entry.state_machine.Sleep(tick_);
+  if (ticks == 0) {
+    return;
+  }
+  entry.asleep = true;
+  entry.asleep_tick = num_of_ticks_;
+  entry.wake_tick = 0;
+  if (ticks > 0) {
+    entry.wake_tick = num_of_ticks_ + ticks + 1;
+    timers_.Schedule(entry.wake_tick, aircrafts_.GetHandle(i));
+  }
+}
+
+void Simulation::CruiseIfAsked(int i) {
+  SimulatedAircraft& entry = aircrafts_.At(i);
+  int ticks = entry.state_machine.Cruise();
+  if (ticks > 0) {
+    entry.cruise_end_tick = num_of_ticks_ + ticks + 1;
+    timers_.Schedule(entry.cruise_end_tick, aircrafts_.GetHandle(i));
+  }
+}
+
+void Simulation::PartitionAsleep() {
+  for (int i = num_of_awake_ - 1; i >= 0; i--) {
+    if (aircrafts_.At(i).asleep) {
+      SwapAircrafts(i, num_of_awake_ - 1);
+      num_of_awake_--;
+    }
+  }
+}
+
+void Simulation::Wake(int i) {
+  SimulatedAircraft& entry = aircrafts_.At(i);
+  entry.state_machine.Wake((num_of_ticks_ - entry.asleep_tick - 1) * tick_);
+  entry.asleep = false;
+  SwapAircrafts(i, num_of_awake_);
+  num_of_awake_++;
+}
+
+void Simulation::SwapAircrafts(int i, int j) {
+  aircrafts_.Swap(i, j);
+  index_of_slot_[aircrafts_.At(i).aircraft->GetSlot()] = i;
+  index_of_slot_[aircrafts_.At(j).aircraft->GetSlot()] = j;
+}
+
+void Simulation::ScheduleTraffic() {
+  float interval = auto_generate_traffic_interval_;
+  long long tick = std::max(num_of_ticks_ + 1, (long long)((last_generate_traffic_time_ + interval) / tick_) - 1);
+  // the same test as on the time of every tick
+  while (float(tick * double(tick_)) - last_generate_traffic_time_ <= interval) {
+    tick++;
+  }
+  traffic_tick_ = tick;
+  timers_.Schedule(traffic_tick_, SlotHandle());
+}
+
+void Simulation::RemoveDeletedAircrafts() {
+  // backwards, the aircraft moved in place of a removed one is already
+  // checked. Only awake aircraft leave.
+  for (int i = num_of_awake_ - 1; i >= 0; i--) {
+    std::shared_ptr<Aircraft> aircraft = aircrafts_.At(i).aircraft;
+    if (aircraft->CanBeDeleted()) {
+      aircraft->ClearLeaderLink();
+      OnAircraftRemoved(aircraft);
+      conflict_grid_.Remove(aircraft->GetSlot());
+      kinematics_.Release(aircraft->GetSlot());
+      // the last awake and then the last aircraft fill the gap
+      SwapAircrafts(i, num_of_awake_ - 1);
+      SwapAircrafts(num_of_awake_ - 1, aircrafts_.Size() - 1);
+      aircrafts_.RemoveAt(aircrafts_.Size() - 1);
+      num_of_awake_--;
+      total_take_off_++;
+    }
+  }
+}
+
+void Simulation::CheckConflicts() {
+  // 1. move the awake active aircraft in the grid, only a change of cell
+  // costs. The dormant ones stay where they fell asleep.
+  for (int i = 0; i < num_of_awake_; i++) {
+    Aircraft& aircraft = *aircrafts_.At(i).aircraft;
+    if (aircraft.IsActive()) {
+      conflict_grid_.Update(aircraft.GetSlot(), aircraft.GetPosition());
+    } else {
+      conflict_grid_.Remove(aircraft.GetSlot());
+    }
+  }
+
+  // 2. test the awake aircraft against those in the neighbouring cells, two
+  // dormant ones did not move since they were last tested
+  for (int i = 0; i < num_of_awake_; i++) {
+    Aircraft& aircraft = *aircrafts_.At(i).aircraft;
+    if (!aircraft.IsActive()) {
+      continue;
+    }
+    conflict_candidates_.clear();
+    conflict_grid_.Query(aircraft.GetPosition(), conflict_candidates_);
+    int first = -1;
+    for (int slot : conflict_candidates_) {
+      int j = index_of_slot_[slot];
+      if (j > i && (first < 0 || j < first) && aircraft.Intersect(*aircrafts_.At(j).aircraft)) {
+        first = j;
+      }
+    }
+    if (first >= 0) {
+      auto& aircraft1 = aircrafts_.At(i).aircraft;
+      auto& aircraft2 = aircrafts_.At(first).aircraft;
+      auto pos1 = aircraft1->GetPosition();
+      auto pos2 = aircraft2->GetPosition();
+      std::cout << aircraft1->GetName() << " at: x " << pos1.x << " y " << pos1.y << std::endl;
+      std::cout << aircraft2->GetName() << " at: x " << pos2.x << " y " << pos2.y << std::endl;
+      std::cout << "Game over" << std::endl;
+      is_game_over_ = true;
+      OnConflict(aircraft1, aircraft2);
+      return;
+    }
+  }
+}
+
+void Simulation::Reset() {
+  for (auto& entry : aircrafts_) {
+    entry.aircraft->ClearLeaderLink();
+    OnAircraftRemoved(entry.aircraft);
+  }
+  aircrafts_.Clear();
+  num_of_awake_ = 0;
+  wake_requests_.clear();
+  kinematics_.Clear();
+  conflict_grid_.Clear();
+  airport_->Reset();
+  is_game_over_ = false;
+  rng_.seed(seed_);
+  num_of_ticks_ = 0;
+  accumulator_ = 0;
+  last_generate_traffic_time_ = 0;
+  total_take_off_ = 0;
+  timers_.Clear();
+  ScheduleTraffic();
+}
+
+const SlotMap<SimulatedAircraft>& Simulation::GetAircrafts() const {
+  return aircrafts_;
+}
+
+const SpatialGrid& Simulation::GetConflictGrid() const {
+  return conflict_grid_;
+}
+
+std::shared_ptr<Aircraft> Simulation::GetAircraft(SlotHandle handle) {
+  SimulatedAircraft* entry = aircrafts_.Get(handle);
+  return entry ? entry->aircraft : nullptr;
+}
+
+float Simulation::GetTime() const {
+  // counted in ticks, a float sum of ticks would drift
+  return num_of_ticks_ * double(tick_);
+}
+
+float Simulation::GetTick() const {
+  return tick_;
+}
+
+unsigned int Simulation::GetSeed() const {
+  return seed_;
+}
+
+int Simulation::GetTotalTakeOff() const {
+  return total_take_off_;
+}
+
+bool Simulation::IsGameOver() const {
+  return is_game_over_;
+}
+
+void Simulation::OnAircraftAdded(std::shared_ptr<Aircraft> aircraft) {
+  for (auto observer : observers_) {
+    observer->OnAircraftAdded(aircraft);
+  }
+}
+
+void Simulation::OnAircraftRemoved(std::shared_ptr<Aircraft> aircraft) {
+  for (auto observer : observers_) {
+    observer->OnAircraftRemoved(aircraft);
+  }
+}
+
+void Simulation::OnGateRequested(std::shared_ptr<Aircraft> aircraft) {
+  controller_asked_ = true;
+  for (auto observer : observers_) {
+    observer->OnGateRequested(aircraft);
+  }
+}
+
+void Simulation::OnGateAssigned(std::shared_ptr<Aircraft> aircraft) {
+  for (auto observer : observers_) {
+    observer->OnGateAssigned(aircraft);
+  }
+}
+
+void Simulation::OnRunwayRequested(std::shared_ptr<Aircraft> aircraft) {
+  controller_asked_ = true;
+  for (auto observer : observers_) {
+    observer->OnRunwayRequested(aircraft);
+  }
+}
+
+void Simulation::OnPushBackRequested(std::shared_ptr<Aircraft> aircraft) {
+  controller_asked_ = true;
+  for (auto observer : observers_) {
+    observer->OnPushBackRequested(aircraft);
+  }
+}
+
+void Simulation::OnTakeOffRequested(std::shared_ptr<Aircraft> aircraft) {
+  controller_asked_ = true;
+  for (auto observer : observers_) {
+    observer->OnTakeOffRequested(aircraft);
+  }
+}
+
+void Simulation::OnManualTaxiHoldAvailable(std::shared_ptr<Aircraft> aircraft, bool available) {
+  for (auto observer : observers_) {
+    observer->OnManualTaxiHoldAvailable(aircraft, available);
+  }
+}
+
+void Simulation::OnManualTaxiResumeAvailable(std::shared_ptr<Aircraft> aircraft) {
+  controller_asked_ = true;
+  for (auto observer : observers_) {
+    observer->OnManualTaxiResumeAvailable(aircraft);
+  }
+}
+
+void Simulation::OnConflict(std::shared_ptr<Aircraft> aircraft, std::shared_ptr<Aircraft> another_aircraft) {
+  for (auto observer : observers_) {
+    observer->OnConflict(aircraft, another_aircraft);
+  }
+}
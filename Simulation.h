@@ -0,0 +1,190 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include <chrono>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "Aircraft.h"
+#include "Airport.h"
+#include "BlockPool.h"
+#include "KinematicsTable.h"
+#include "SimulationObserver.h"
+#include "SlotMap.h"
+#include "SpatialGrid.h"
+#include "StateMachine.h"
+#include "TimerWheel.h"
+#include "WorkerPool.h"
+
+// Default length of one simulation tick, seconds
+#define SIMULATION_TICK (1.0 / 60)
+// Default cap of ticks run by one Advance
+#define MAX_TICKS_PER_ADVANCE 256
+// Default cap of the wall time one Advance or Warp takes, seconds, so a
+// frame stays short however many aircraft a high speed has to run
+#define MAX_WALL_TIME_PER_ADVANCE 0.02
+// Fewer aircraft than this decide on the calling thread only, waking the
+// workers would cost more than it saves
+#define MIN_AIRCRAFTS_TO_DECIDE_IN_PARALLEL 64
+
+// An aircraft of the simulation and the state machine driving it
+struct SimulatedAircraft {
+  std::shared_ptr<Aircraft> aircraft;
+  StateMachine state_machine;
+  // the state machine sleeps until wake_tick, or until the aircraft is told
+  // something if wake_tick is 0
+  bool asleep = false;
+  long long asleep_tick = 0; // the last tick it was updated
+  long long wake_tick = 0;
+  // the aircraft cruises, its machine is interrupted on this tick
+  long long cruise_end_tick = 0;
+};
+
+// The aircraft, their state machines and the traffic of one game. Nothing is
+// drawn here: the UI registers observers and reads the aircraft data, so the
+// simulation also runs without a window.
+//
+// The simulation only moves by fixed ticks and draws every random number
+// from one engine seeded at construction, so the same seed and the same
+// player actions give the same game, whatever the frame rate or speed.
+class Simulation : public SimulationObserver {
+  public:
+    Simulation(std::shared_ptr<Airport> airport, unsigned int seed,
+               float tick = SIMULATION_TICK,
+               int max_ticks_per_advance = MAX_TICKS_PER_ADVANCE);
+    virtual ~Simulation();
+
+    // Observers are not owned, they have to outlive the simulation
+    void AddObserver(SimulationObserver* observer);
+
+    // Add an aircraft, it lands on the runway 2 mins later. The handle
+    // stays valid until the aircraft is removed.
+    SlotHandle AddAircraft(AircraftIdentification id,
+                           std::shared_ptr<RunwayInfo> landing_runway_info);
+    // Add a random aircraft landing on a random active runway
+    void GenerateTraffic();
+    void SetAutoGenerateTraffic(bool is_auto_generate_traffic);
+    // Threads deciding the aircraft of a tick, the calling one included.
+    // Any number gives the same game.
+    void SetNumOfThreads(int num_of_threads);
+
+    // Add elapsed seconds of simulation time and run the whole ticks they
+    // make up, the rest is kept for the next call. Past the tick cap or the
+    // wall time cap the time left is dropped, so a slow frame slows the
+    // game down instead of making every later frame slower. Returns the
+    // number of ticks run.
+    int Advance(float elapsed);
+    // Run a single tick. Nothing moves once game over.
+    void Step();
+    // Run ticks until an aircraft asks the controller for something (a gate,
+    // a runway, push back, take off or to resume taxiing), at most
+    // max_ticks or the wall time cap. Returns whether it stopped for a
+    // request or game over. The game is the same as stepping tick by tick.
+    bool Warp(int max_ticks);
+    // Wall time cap of Advance and Warp in seconds, 0 for none. Every tick
+    // is still run whole, only fewer of them.
+    void SetMaxWallTimePerAdvance(float seconds);
+    // Remove every aircraft and start a new game with the same seed
+    void Reset();
+
+    // In update order, the awake aircraft first. The order changes when an
+    // aircraft is removed, falls asleep or wakes.
+    const SlotMap<SimulatedAircraft>& GetAircrafts() const;
+    // the active aircraft by position, awake or asleep
+    const SpatialGrid& GetConflictGrid() const;
+    // nullptr once the aircraft is removed
+    std::shared_ptr<Aircraft> GetAircraft(SlotHandle handle);
+    // Simulation time since the game started, seconds
+    float GetTime() const;
+    float GetTick() const;
+    unsigned int GetSeed() const;
+    int GetTotalTakeOff() const;
+    bool IsGameOver() const;
+
+    // SimulationObserver, forwarded to every observer
+    void OnAircraftAdded(std::shared_ptr<Aircraft> aircraft) override;
+    void OnAircraftRemoved(std::shared_ptr<Aircraft> aircraft) override;
+    void OnGateRequested(std::shared_ptr<Aircraft> aircraft) override;
+    void OnGateAssigned(std::shared_ptr<Aircraft> aircraft) override;
+    void OnRunwayRequested(std::shared_ptr<Aircraft> aircraft) override;
+    void OnPushBackRequested(std::shared_ptr<Aircraft> aircraft) override;
+    void OnTakeOffRequested(std::shared_ptr<Aircraft> aircraft) override;
+    void OnManualTaxiHoldAvailable(std::shared_ptr<Aircraft> aircraft, bool available) override;
+    void OnManualTaxiResumeAvailable(std::shared_ptr<Aircraft> aircraft) override;
+    void OnConflict(std::shared_ptr<Aircraft> aircraft, std::shared_ptr<Aircraft> another_aircraft) override;
+
+  private:
+    // Mark the aircraft at i asleep if its state asks to, after Commit. It
+    // moves to the dormant part of the list at the end of the tick.
+    void SleepIfAsked(int i);
+    // Time the cruise of the aircraft at i if it starts one, after Move. It
+    // stays awake, with nothing run for it until the cruise ends.
+    void CruiseIfAsked(int i);
+    // Move the aircraft marked asleep to the dormant part of the list
+    void PartitionAsleep();
+    // Move the dormant aircraft at i back to the awake ones
+    void Wake(int i);
+    // Swap two aircraft in the list, their handles stay valid
+    void SwapAircrafts(int i, int j);
+    // Timer of the next auto generated traffic, on the first tick past the
+    // interval since the last one
+    void ScheduleTraffic();
+    // Whether the wall time cap is used up since start
+    bool IsOverWallTime(std::chrono::steady_clock::time_point start) const;
+    // Remove the aircraft that have left
+    void RemoveDeletedAircrafts();
+    // Game over once two active aircraft intersect. Only awake aircraft
+    // move, so only they are checked, against the candidates of the
+    // conflict grid. The pair reported is the first one in the order of the
+    // aircraft list.
+    void CheckConflicts();
+
+  private:
+    std::shared_ptr<Airport> airport_;
+    std::vector<SimulationObserver*> observers_;
+
+    unsigned int seed_;
+    std::mt19937 rng_;
+    float tick_;
+    int max_ticks_per_advance_;
+    float max_wall_time_per_advance_ = MAX_WALL_TIME_PER_ADVANCE;
+    long long num_of_ticks_ = 0;
+    float accumulator_ = 0; // simulation time not run yet, less than a tick
+
+    // the first num_of_awake_ aircraft are updated, the others are dormant
+    // and only wait for a timer or to be told something
+    SlotMap<SimulatedAircraft> aircrafts_;
+    // memory of the aircraft, a block freed by a removed one goes to the
+    // next one added
+    std::shared_ptr<BlockPool> aircraft_pool_;
+    int num_of_awake_ = 0;
+    std::vector<int> index_of_slot_;   // index in aircrafts_, per slot
+    // slots of the aircraft told something by the controller, see Aircraft
+    std::vector<int> wake_requests_;
+    // wakes sleeping aircraft and ends cruises, by handle, and generates the
+    // auto traffic, with no handle. Turns with the ticks.
+    TimerWheel<SlotHandle> timers_;
+    std::vector<SlotHandle> timers_due_;
+    long long traffic_tick_ = 0; // of the only valid traffic timer
+    // kinematic state of the aircraft, a slot each
+    KinematicsTable kinematics_;
+    std::unique_ptr<WorkerPool> workers_;
+    // active aircraft by position, by slot. Cells are twice the largest
+    // conflict radius, so every intersecting pair is in neighbouring cells.
+    SpatialGrid conflict_grid_;
+    float max_aircraft_radius_ = 0;
+    std::vector<int> conflict_candidates_;
+
+    std::vector<std::string> calling_name_pool_;
+    std::vector<AircraftIdentification> aircraft_identification_pool_;
+
+    bool is_game_over_ = false;
+    bool controller_asked_ = false; // a request went to the observers
+    bool is_auto_generate_traffic_ = true;
+    float last_generate_traffic_time_ = 0;
+    int auto_generate_traffic_interval_ = 600; // 10 min
+    int total_take_off_ = 0;
+};
+
+#endif // SIMULATION_H
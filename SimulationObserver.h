@@ -0,0 +1,35 @@
+#ifndef SIMULATIONOBSERVER_H
+#define SIMULATIONOBSERVER_H
+
+#include <memory>
+
+class Aircraft;
+
+// Notifications from the simulation core to whatever presents it, e.g. the
+// banner panel or the aircraft sprites. The core only calls these and never
+// reads anything back. Every notification does nothing by default, so a
+// headless run can use this class as is.
+class SimulationObserver {
+  public:
+    virtual ~SimulationObserver() {}
+
+    virtual void OnAircraftAdded(std::shared_ptr<Aircraft> aircraft) {}
+    // The aircraft left the simulation, it is not updated any more
+    virtual void OnAircraftRemoved(std::shared_ptr<Aircraft> aircraft) {}
+
+    virtual void OnGateRequested(std::shared_ptr<Aircraft> aircraft) {}
+    virtual void OnGateAssigned(std::shared_ptr<Aircraft> aircraft) {}
+    virtual void OnRunwayRequested(std::shared_ptr<Aircraft> aircraft) {}
+    virtual void OnPushBackRequested(std::shared_ptr<Aircraft> aircraft) {}
+    virtual void OnTakeOffRequested(std::shared_ptr<Aircraft> aircraft) {}
+
+    // Whether the aircraft can be told to hold while taxiing
+    virtual void OnManualTaxiHoldAvailable(std::shared_ptr<Aircraft> aircraft, bool available) {}
+    // The aircraft holds for traffic and waits to be told to resume
+    virtual void OnManualTaxiResumeAvailable(std::shared_ptr<Aircraft> aircraft) {}
+
+    // Two aircraft intersect, the simulation is over
+    virtual void OnConflict(std::shared_ptr<Aircraft> aircraft, std::shared_ptr<Aircraft> another_aircraft) {}
+};
+
+#endif // SIMULATIONOBSERVER_H
@@ -0,0 +1,113 @@
+#ifndef SLOTMAP_H
+#define SLOTMAP_H
+
+#include <utility>
+#include <vector>
+
+// Stable reference to a value of a SlotMap. A handle to a removed value
+// stays invalid, even once its slot holds a later value.
+struct SlotHandle {
+  int slot = -1;
+  unsigned int generation = 0;
+};
+
+// Values stored densely for iteration, reached through stable handles.
+// Insert and Remove are O(1): a removed value is replaced by the last one,
+// so Remove changes the iteration order, deterministically. Slots and the
+// storage of removed values are reused.
+template <typename T>
+class SlotMap {
+  public:
+    SlotMap() {}
+
+    SlotHandle Insert(T value) {
+      int slot;
+      if (free_slots_.empty()) {
+        slot = slots_.size();
+        slots_.push_back({-1, 0});
+      } else {
+        slot = free_slots_.back();
+        free_slots_.pop_back();
+      }
+      slots_[slot].dense = values_.size();
+      values_.push_back(std::move(value));
+      dense_to_slot_.push_back(slot);
+      return {slot, slots_[slot].generation};
+    }
+
+    // Returns false if the handle is not valid any more
+    bool Remove(SlotHandle handle) {
+      if (!Contains(handle)) {
+        return false;
+      }
+      RemoveAt(slots_[handle.slot].dense);
+      return true;
+    }
+
+    // Remove the value at dense index i, the last one takes its place
+    void RemoveAt(int i) {
+      int slot = dense_to_slot_[i];
+      int last = values_.size() - 1;
+      if (i != last) {
+        values_[i] = std::move(values_[last]);
+        dense_to_slot_[i] = dense_to_slot_[last];
+        slots_[dense_to_slot_[i]].dense = i;
+      }
+      values_.pop_back();
+      dense_to_slot_.pop_back();
+      slots_[slot].dense = -1;
+      slots_[slot].generation++;
+      free_slots_.push_back(slot);
+    }
+
+    // Swap the values at dense indices i and j, their handles stay valid
+    void Swap(int i, int j) {
+      if (i == j) {
+        return;
+      }
+      std::swap(values_[i], values_[j]);
+      std::swap(dense_to_slot_[i], dense_to_slot_[j]);
+      slots_[dense_to_slot_[i]].dense = i;
+      slots_[dense_to_slot_[j]].dense = j;
+    }
+
+    void Clear() {
+      while (!values_.empty()) {
+        RemoveAt(values_.size() - 1);
+      }
+    }
+
+    bool Contains(SlotHandle handle) const {
+      return handle.slot >= 0 && handle.slot < int(slots_.size()) &&
+             slots_[handle.slot].generation == handle.generation &&
+             slots_[handle.slot].dense >= 0;
+    }
+    // nullptr if the handle is not valid any more
+    T* Get(SlotHandle handle) {
+      return Contains(handle) ? &values_[slots_[handle.slot].dense] : nullptr;
+    }
+
+    // Dense access, for iteration
+    int Size() const { return values_.size(); }
+    bool Empty() const { return values_.empty(); }
+    T& At(int i) { return values_[i]; }
+    const T& At(int i) const { return values_[i]; }
+    SlotHandle GetHandle(int i) const { return {dense_to_slot_[i], slots_[dense_to_slot_[i]].generation}; }
+    typename std::vector<T>::iterator begin() { return values_.begin(); }
+    typename std::vector<T>::iterator end() { return values_.end(); }
+    typename std::vector<T>::const_iterator begin() const { return values_.begin(); }
+    typename std::vector<T>::const_iterator end() const { return values_.end(); }
+
+  private:
+    struct Slot {
+      int dense;               // index in values_, -1 if free
+      unsigned int generation; // increased on every Remove
+    };
+
+    std::vector<Slot> slots_;
+    std::vector<T> values_;
+    std::vector<int> dense_to_slot_;
+    std::vector<int> free_slots_;
+};
+
+#endif // SLOTMAP_H
@@ -0,0 +1,69 @@
+#include "SpatialGrid.h"
+#include <algorithm>
+#include <math.h>
+
+SpatialGrid::SpatialGrid(float cell_size)
+  : cell_size_(cell_size) {
+}
+
+void SpatialGrid::SetCellSize(float cell_size) {
+  cell_size_ = cell_size;
+  Clear();
+}
+
+void SpatialGrid::Update(int slot, sf::Vector2f position) {
+  if (slot >= int(in_grid_.size())) {
+    in_grid_.resize(slot + 1, false);
+    cell_of_slot_.resize(slot + 1, 0);
+  }
+  long long key = CellKey(position);
+  if (in_grid_[slot]) {
+    if (cell_of_slot_[slot] == key) {
+      return;
+    }
+    Remove(slot);
+  }
+  cells_[key].push_back(slot);
+  in_grid_[slot] = true;
+  cell_of_slot_[slot] = key;
+}
+
+void SpatialGrid::Remove(int slot) {
+  if (slot >= int(in_grid_.size()) || !in_grid_[slot]) {
+    return;
+  }
+  auto it = cells_.find(cell_of_slot_[slot]);
+  std::vector<int>& cell = it->second;
+  // order within a cell does not matter. An empty cell is kept, the next
+  // aircraft passing through it does not allocate it again.
+  *std::find(cell.begin(), cell.end(), slot) = cell.back();
+  cell.pop_back();
+  in_grid_[slot] = false;
+}
+
+void SpatialGrid::Clear() {
+  cells_.clear();
+  in_grid_.clear();
+  cell_of_slot_.clear();
+}
+
+void SpatialGrid::Query(sf::Vector2f position, std::vector<int>& result) const {
+  int cell_x = int(floor(position.x / cell_size_));
+  int cell_y = int(floor(position.y / cell_size_));
+  for (int x = cell_x - 1; x <= cell_x + 1; x++) {
+    for (int y = cell_y - 1; y <= cell_y + 1; y++) {
+      auto it = cells_.find(CellKey(x, y));
+      if (it != cells_.end()) {
+        result.insert(result.end(), it->second.begin(), it->second.end());
+      }
+    }
+  }
+}
+
+long long SpatialGrid::CellKey(int cell_x, int cell_y) const {
+  return (static_cast<long long>(cell_x) << 32) | static_cast<unsigned int>(cell_y);
+}
+
+long long SpatialGrid::CellKey(sf::Vector2f position) const {
+  return CellKey(int(floor(position.x / cell_size_)), int(floor(position.y / cell_size_)));
+}
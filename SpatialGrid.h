@@ -0,0 +1,44 @@
+#ifndef SPATIALGRID_H
+#define SPATIALGRID_H
+
+#include <unordered_map>
+#include <vector>
+#include <SFML/System/Vector2.hpp>
+
+// Uniform grid over world positions, hashed by cell, holding aircraft
+// slots. With a cell size of at least the largest distance of interest,
+// everything within that distance of a position is in its cell or in one of
+// the 8 around it. Moving an aircraft only touches the grid when it changes
+// cell.
+class SpatialGrid {
+  public:
+    SpatialGrid(float cell_size);
+
+    // Changing the cell size empties the grid
+    void SetCellSize(float cell_size);
+    float GetCellSize() const { return cell_size_; }
+
+    // Insert the slot, or move it if it is already in the grid
+    void Update(int slot, sf::Vector2f position);
+    void Remove(int slot);
+    void Clear();
+    bool Contains(int slot) const {
+      return slot < int(in_grid_.size()) && in_grid_[slot];
+    }
+
+    // Append the slots in the cell of position and in the 8 around it
+    void Query(sf::Vector2f position, std::vector<int>& result) const;
+
+  private:
+    long long CellKey(int cell_x, int cell_y) const;
+    long long CellKey(sf::Vector2f position) const;
+
+  private:
+    float cell_size_;
+    std::unordered_map<long long, std::vector<int>> cells_;
+    // per slot, whether it is in the grid and in which cell
+    std::vector<unsigned char> in_grid_;
+    std::vector<long long> cell_of_slot_;
+};
+
+#endif // SPATIALGRID_H
@@ -1,530 +1,541 @@
 #include "State.h"
+#include <algorithm>
 #include <iostream>
 #include <math.h>
 #include <limits.h>
 #include "Aircraft.h"
-#include "BannerPanel.h"
-
-InitialState::InitialState(std::shared_ptr<Aircraft> aircraft,
-                           std::shared_ptr<BannerPanel> panel)
-  : State(aircraft, panel) {
-  state_name_ = "Initial";
-}
-
-std::string InitialState::Entry() {
-  panel_->RequestGate(aircraft_);
-  aircraft_->request_of_gate_sent_ = true;
-  return state_name_;
-}
-
-std::string InitialState::Update(float dt) {
-  if ( timer_ < before_landing_interval ) {
-    auto banner = panel_->GetBanner(aircraft_);
-    banner->SetText(aircraft_->GetName() + "|" + aircraft_->GetModel() + "|IN:" + std::to_string(int(round(before_landing_interval-timer_))) + "s", 1);
-    timer_ += dt;
-    return state_name_;
+#include "SimulationObserver.h"
+
+const State* State::Get(StateId id) {
+  // built on first use, read only afterwards, so every thread can share them
+  static const InitialState initial;
+  static const TouchDownState touch_down;
+  static const MaintainSpeedState maintain_speed;
+  static const StopState stop;
+  static const IdleState idle;
+  static const RequestRunwayState request_runway;
+  static const RequestPushBackState request_push_back;
+  static const PushBackState push_back;
+  static const TakeOffState take_off;
+  static const HoldState hold;
+  static const LeavingState leaving;
+  static const State* const states[NUM_OF_STATES] = {
+      &initial, &touch_down, &maintain_speed, &stop, &idle, &request_runway,
+      &request_push_back, &push_back, &take_off, &hold, &leaving};
+  return states[id];
+}
+
+InitialState::InitialState()
+  : State(INITIAL, "Initial") {
+}
+
+StateId InitialState::Entry(StateContext& context) const {
+  const std::shared_ptr<Aircraft>& aircraft = context.aircraft;
+  context.observer->OnGateRequested(aircraft);
+  aircraft->request_of_gate_sent_ = true;
+  return id_;
+}
+
+StateId InitialState::Update(StateContext& context, float dt) const {
+  if ( context.timer < BEFORE_LANDING_INTERVAL ) {
+    context.timer += dt;
+    // nothing happens before landing
+    context.sleep = std::max(BEFORE_LANDING_INTERVAL - context.timer, 0.0f);
+    return id_;
   } else {
-    return "TouchDown";
+    return StateId::TOUCH_DOWN;
   }
 }
 
-TouchDownState::TouchDownState(std::shared_ptr<Aircraft> aircraft,
-                               std::shared_ptr<BannerPanel> panel)
-  : State(aircraft, panel) {
-  state_name_ = "TouchDown";
+TouchDownState::TouchDownState()
+  : State(TOUCH_DOWN, "TouchDown") {
 }
 
-std::string TouchDownState::Entry() {
-  auto landing_runway_info = aircraft_->GetLandingRunwayInfo();
-  aircraft_->SetGroundRoute(landing_runway_info->route, landing_runway_info->direction, landing_runway_info->touch_down_distance_range[1]);
-  aircraft_->Activate();
-  aircraft_->SetSpeed(KnotsToMetersPerSecond(160));
-  auto banner = panel_->GetBanner(aircraft_);
-  auto airport = banner->GetAirport();
-  if (aircraft_->gate_assigned_.empty()) {
+StateId TouchDownState::Entry(StateContext& context) const {
+  const std::shared_ptr<Aircraft>& aircraft = context.aircraft;
+  auto landing_runway_info = aircraft->GetLandingRunwayInfo();
+  aircraft->SetGroundRoute(landing_runway_info->route, landing_runway_info->direction, landing_runway_info->touch_down_distance_range[1]);
+  aircraft->Activate();
+  aircraft->SetSpeed(KnotsToMetersPerSecond(160));
+  aircraft->touch_down_time_ = -1;
+  auto airport = aircraft->airport_;
+  if (aircraft->gate_assigned_.empty()) {
     // TODO: auto assign gate goes here.
-    auto gates_vec = airport->GetGatesWithExactSize(aircraft_->GetSize());
+    // the least used gate, a random one of them if several
+    auto gates_vec = airport->GetGatesWithExactSize(aircraft->GetSize());
     int num_of_aircrafts = INT_MAX;
-    int index = 0;
+    std::vector<Gate*> least_used_gates;
     for (int i = 0; i < gates_vec.size(); i++) {
       int n = gates_vec[i]->GetAssignedAircraftNumber();
       if (n < num_of_aircrafts) {
-        index = i;
+        least_used_gates.clear();
         num_of_aircrafts = n;
       }
+      if (n == num_of_aircrafts) {
+        least_used_gates.push_back(gates_vec[i]);
+      }
     }
-    aircraft_->gate_assigned_ = gates_vec[index]->GetName();
-    gates_vec[index]->AssignAircraft(aircraft_);
+    Gate* gate = *select_randomly(least_used_gates.begin(), least_used_gates.end(), *aircraft->rng_);
+    aircraft->gate_assigned_ = gate->GetName();
+    gate->AssignAircraft(aircraft);
   }
-  if (!aircraft_->gate_assigned_.empty()) {
-    aircraft_->SetTaxiRoutes(airport->GetRoute(aircraft_->GetRoute(), aircraft_->GetDirectionOnRoute(),
-                                               aircraft_->GetDistanceOnRoute(),
-                                               airport->GetRoutePtr(aircraft_->gate_assigned_),
+  if (!aircraft->gate_assigned_.empty()) {
+    aircraft->SetTaxiRoutes(airport->GetRoute(aircraft->GetRoute(), aircraft->GetDirectionOnRoute(),
+                                               aircraft->GetDistanceOnRoute(),
+                                               airport->GetRoutePtr(aircraft->gate_assigned_),
                                                true, 1));
-    banner->DisableGateSelector();
+    context.observer->OnGateAssigned(aircraft);
   }
-  return "MaintainSpeed";
+  return StateId::MAINTAIN_SPEED;
 }
 
-MaintainSpeedState::MaintainSpeedState(std::shared_ptr<Aircraft> aircraft,
-                                       std::shared_ptr<BannerPanel> panel)
-  : State(aircraft, panel) {
-  state_name_ = "MaintainSpeed";
+MaintainSpeedState::MaintainSpeedState()
+  : State(MAINTAIN_SPEED, "MaintainSpeed") {
 }
 
-std::string MaintainSpeedState::Entry() {
-  if (aircraft_->taxi_routes_.empty()) {
-    if (aircraft_->clearance_of_line_up_received_ && aircraft_->clearance_of_take_off_received_) {
-      return "TakeOff";
+StateId MaintainSpeedState::Entry(StateContext& context) const {
+  const std::shared_ptr<Aircraft>& aircraft = context.aircraft;
+  if (aircraft->taxi_path_.Empty()) {
+    if (aircraft->clearance_of_line_up_received_ && aircraft->clearance_of_take_off_received_) {
+      return StateId::TAKE_OFF;
     } else {
-      return "IdleState";
+      return StateId::IDLE;
     }
   }
-  current_route_ = aircraft_->route_;
-  current_route_speed_limit_ = KnotsToMetersPerSecond(current_route_->GetTaxiSpeedLimit());
-  if (aircraft_->taxi_routes_.size() > 1) {
-    next_route_ = current_route_->GetConnectionInfo(*std::next(aircraft_->taxi_routes_.begin())).next_piece;
-    next_route_speed_limit_ = KnotsToMetersPerSecond(next_route_->GetTaxiSpeedLimit());
-  } else {
-    next_route_ = nullptr;
-    next_route_speed_limit_ = 0;
-  }
-  if (aircraft_->distance_to_next_hold_ <= 0) {
-    aircraft_->distance_to_next_hold_ = aircraft_->route_->GetDistanceToNextHold(aircraft_->taxi_routes_,
-                                                                               aircraft_->distance_on_route_,
-                                                                               aircraft_->direction_on_route_,
-                                                                               aircraft_->next_hold_type_);
+  context.current_route = aircraft->GetRoute();
+  if (aircraft->DistanceToNextHold() <= 0) {
+    aircraft->DistanceToNextHold() = aircraft->taxi_path_.GetDistanceToNextHold(aircraft->next_hold_type_);
   }
+  PlanSpeedProfile(context);
+  aircraft->status_ = "TAXI TO " + aircraft->GetTaxiRoutes().Back()->GetName();
 
-  panel_->TurnOnManualTaxiHold(aircraft_);
+  context.observer->OnManualTaxiHoldAvailable(aircraft, true);
 
-  return state_name_;
+  return id_;
 }
 
-std::string MaintainSpeedState::Update(float dt) {
+StateId MaintainSpeedState::Update(StateContext& context, float dt) const {
+  const std::shared_ptr<Aircraft>& aircraft = context.aircraft;
   //meters, need to make caution if a flight is within this distance in the way
   // make this adaptive to the speed of the aircraft
-  float caution_follow_distance = 100 + aircraft_->GetLength() / 2 + aircraft_->GetSpeed() * 7;
-  float result_search_distance = caution_follow_distance;
-  auto leading_aircraft = aircraft_->route_->ClosestAircraftInWay(aircraft_,
-                                             result_search_distance,
-                                             aircraft_->GetDirectionOnRoute(),
-                                             aircraft_->GetDistanceOnRoute());
-
-  // break ahead of
-  float brake_ahead_distance = 200 + aircraft_->GetLength() / 2; // meters
-
-  // 1.4 Setup panel display
-  auto banner = panel_->GetBanner(aircraft_);
-  banner->SetText(aircraft_->GetName() + "|" + aircraft_->GetModel() + "|SPD:" + std::to_string(int(round(aircraft_->GetSpeed()))), 1);
-  banner->SetText("TAXI TO " + aircraft_->GetTaxiRoutes().back(), 2);
-  banner->SetText(aircraft_->GetTaxiRoutesString(), 3);
+  float caution_follow_distance = 100 + aircraft->GetLength() / 2 + aircraft->GetSpeed() * 7;
+  auto leading_aircraft = aircraft->FindLeader(caution_follow_distance, dt);
 
   // 1.5 Compute target speed and acceleration
-  float target_speed = current_route_speed_limit_;
-  if (aircraft_->taxi_routes_.size() > 1) {
-    float break_out_dist = aircraft_->route_->GetConnectionInfo(
-      next_route_->GetName()).distance_to_break_out;
-    bool close_to_next_route = aircraft_->direction_on_route_ ?
-    (aircraft_->distance_on_route_ + brake_ahead_distance >= break_out_dist) :
-    (aircraft_->distance_on_route_ - brake_ahead_distance <= break_out_dist);
-    if (close_to_next_route &&
-        target_speed > next_route_speed_limit_) {
-      target_speed = next_route_speed_limit_;
-    }
+  // the profile already brakes ahead of slower routes, hold points and the
+  // end of the path, the leading aircraft changes every tick and is only a cap
+  if ((context.planned_with_take_off_clearance != aircraft->clearance_of_take_off_received_) ||
+      (context.replan_needed && !aircraft->manual_taxi_hold_)) {
+    PlanSpeedProfile(context);
   }
+  float target_speed = aircraft->taxi_path_.GetPlannedSpeed();
   if (leading_aircraft) {
     target_speed = std::min(target_speed, leading_aircraft->GetSpeed());
   }
-  if (aircraft_->manual_taxi_hold_) {
+  if (aircraft->manual_taxi_hold_) {
     target_speed = 0;
   }
 
-  if (aircraft_->speed_ > target_speed + KnotsToMetersPerSecond(20)) {
-    aircraft_->acceleration_ = aircraft_->DetermineAcceleration(
+  if (aircraft->Speed() > target_speed + KnotsToMetersPerSecond(20)) {
+    aircraft->Acceleration() = aircraft->DetermineAcceleration(
                                  target_speed, dt,
-                                 aircraft_->soft_ground_acceleration_,
-                                 aircraft_->max_ground_deacceleration_);
+                                 aircraft->soft_ground_acceleration_,
+                                 aircraft->max_ground_deacceleration_);
   } else {
-    aircraft_->acceleration_ = aircraft_->DetermineAcceleration(
+    aircraft->Acceleration() = aircraft->DetermineAcceleration(
                                  target_speed, dt,
-                                 aircraft_->soft_ground_acceleration_,
-                                 aircraft_->soft_ground_deacceleration_);
+                                 aircraft->soft_ground_acceleration_,
+                                 aircraft->soft_ground_deacceleration_);
   }
 
-  // 2. update speed, distance, distance_to_next_hold
-  float dv = aircraft_->acceleration_ * dt;
-  float dist = (aircraft_->speed_ + dv / 2.0) * dt;
-  aircraft_->speed_ += dv;
-  aircraft_->distance_to_next_hold_ -= dist;
-  if (aircraft_->distance_to_next_hold_ <= -aircraft_->length_ / 2) {
-    aircraft_->distance_to_next_hold_ = aircraft_->route_->GetDistanceToNextHold(aircraft_->taxi_routes_,
-                                                                               aircraft_->distance_on_route_,
-                                                                               aircraft_->direction_on_route_,
-                                                                               aircraft_->next_hold_type_);
+  // cruising at the plan with nobody close ahead, nothing changes until the
+  // plan does or the search of the leader link is used up
+  context.cruise_ticks = 0;
+  float speed = aircraft->Speed();
+  if (aircraft->Acceleration() == 0 && speed > 0 && target_speed == speed &&
+      !aircraft->leader_link_.leader_route && !aircraft->leader_link_.runway_traffic &&
+      !aircraft->manual_taxi_hold_) {
+    const LeaderLink& link = aircraft->leader_link_;
+    double travelled = aircraft->taxi_path_.GetTravelledDistance() - link.travelled;
+    double skin = link.search_distance - caution_follow_distance - travelled -
+                  link.age * LEADER_MAX_CLOSING_SPEED;
+    double horizon = std::min(aircraft->taxi_path_.GetPlannedSpeedRun() / speed,
+                              skin / (speed + LEADER_MAX_CLOSING_SPEED));
+    // a tick short, the distances are summed tick by tick
+    context.cruise_ticks = int(std::min(horizon / dt, double(INT_MAX))) - 1;
+  }
+  return id_;
+}
+
+StateId MaintainSpeedState::Move(StateContext& context, float dt) const {
+  const std::shared_ptr<Aircraft>& aircraft = context.aircraft;
+  // 2. speed is integrated, update distance_to_next_hold
+  float dist = aircraft->GetDeltaDistance();
+  aircraft->DistanceToNextHold() -= dist;
+  if (aircraft->DistanceToNextHold() <= -aircraft->length_ / 2) {
+    aircraft->DistanceToNextHold() = aircraft->taxi_path_.GetDistanceToNextHold(aircraft->next_hold_type_);
   }
 
   // 3. update position
-  aircraft_->route_->ComputePosition(aircraft_, aircraft_->distance_on_route_, aircraft_->direction_on_route_, dist, &(aircraft_->route_), aircraft_->taxi_routes_);
-  aircraft_->sprite_.setPosition(ToSfmlPosition(aircraft_->route_->GetBreakOutPosition(
-                                         aircraft_->distance_on_route_)));
-  aircraft_->sprite_.setRotation(ToSfmlRotation(aircraft_->route_->GetRotation(
-                                         aircraft_->distance_on_route_, aircraft_->direction_on_route_)));
+  aircraft->MoveAlongTaxiPath(dist);
 
   // 3.5 Update current_route if needed
-  if (aircraft_->taxi_routes_.empty()) {
-    if (aircraft_->clearance_of_take_off_received_) {
-      return "TakeOff";
+  if (aircraft->taxi_path_.Empty()) {
+    if (aircraft->clearance_of_take_off_received_) {
+      return StateId::TAKE_OFF;
     }
-    return "IdleState";
+    return StateId::IDLE;
   }
-  if (aircraft_->route_ != current_route_) {
-    current_route_ = aircraft_->route_;
-    if (current_route_->GetRouteType() == RouteType::GATE && !aircraft_->gate_) {
-      aircraft_->gate_ = current_route_;
-    }
-    current_route_speed_limit_ = KnotsToMetersPerSecond(current_route_->GetTaxiSpeedLimit());
-    if (aircraft_->taxi_routes_.size() > 1) {
-      next_route_ = current_route_->GetConnectionInfo(*std::next(aircraft_->taxi_routes_.begin())).next_piece;
-      next_route_speed_limit_ = KnotsToMetersPerSecond(next_route_->GetTaxiSpeedLimit());
-    } else {
-      next_route_ = nullptr;
-      next_route_speed_limit_ = 0;
+  if (aircraft->GetRoute() != context.current_route) {
+    context.current_route = aircraft->GetRoute();
+    if (context.current_route->GetRouteType() == RouteType::GATE && !aircraft->gate_) {
+      aircraft->gate_ = context.current_route;
     }
   }
 
   // 3.6 if this is the last route and distance to the end <= v^2/(2*a) || distance to hold <= v^2/(2*a), to StopState
   // Ignore hold and stop if clearance of take off received
-  if (!aircraft_->clearance_of_take_off_received_) {
-    float break_distance = abs(aircraft_->speed_ * aircraft_->speed_ / 2 / aircraft_->soft_ground_deacceleration_);
-    if ((aircraft_->taxi_routes_.size() == 1) &&
-      (break_distance >= (aircraft_->direction_on_route_ ? aircraft_->route_->GetLength() - aircraft_->distance_on_route_ : aircraft_->distance_on_route_))) {
-      return "Stop";
+  if (!aircraft->clearance_of_take_off_received_) {
+    float break_distance = abs(aircraft->Speed() * aircraft->Speed() / 2 / aircraft->soft_ground_deacceleration_);
+    if ((aircraft->taxi_path_.Size() == 1) &&
+      (break_distance >= aircraft->taxi_path_.GetDistanceToRouteEnd())) {
+      return StateId::STOP;
     }
     // HoldPointType next_hold_type = HoldPointType::NOTSET;
     // should compute use nose position, add this compensation
-    // float compensate_distance = aircraft_->direction_on_route_ ? aircraft_->length_/2 : -aircraft_->length_/2;
-    float compensate_distance = aircraft_->length_ / 2;
-    if (aircraft_->speed_ <= KnotsToMetersPerSecond(aircraft_->route_->GetTaxiSpeedLimit()) &&
-        break_distance + compensate_distance >= aircraft_->distance_to_next_hold_ && aircraft_->next_hold_type_ != HoldPointType::NOTSET) {
-      if (aircraft_->next_hold_type_ == HoldPointType::TAKEOFF) {
-        return "Hold";
-      } else if (aircraft_->next_hold_type_ == HoldPointType::TRAFFIC) {
-        aircraft_->manual_taxi_hold_ = true;
-        aircraft_->next_hold_type_ = HoldPointType::NOTSET;
-        banner->TurnOnManualTaxiResume();
+    // float compensate_distance = aircraft->direction_on_route_ ? aircraft->length_/2 : -aircraft->length_/2;
+    float compensate_distance = aircraft->length_ / 2;
+    if (aircraft->Speed() <= KnotsToMetersPerSecond(aircraft->GetRoute()->GetTaxiSpeedLimit()) &&
+        break_distance + compensate_distance >= aircraft->DistanceToNextHold() && aircraft->next_hold_type_ != HoldPointType::NOTSET) {
+      if (aircraft->next_hold_type_ == HoldPointType::TAKEOFF) {
+        aircraft->taxi_path_.ReleaseNextHold();
+        return StateId::HOLD;
+      } else if (aircraft->next_hold_type_ == HoldPointType::TRAFFIC) {
+        aircraft->taxi_path_.ReleaseNextHold();
+        context.replan_needed = true;
+        aircraft->manual_taxi_hold_ = true;
+        context.cruise_ticks = 0;
+        aircraft->next_hold_type_ = HoldPointType::NOTSET;
+        context.observer->OnManualTaxiResumeAvailable(aircraft);
+      }
+    }
+  }
+
+  // 3.7 cruise alone on the route, no further than any of the checks above
+  // could fire. A tick short of each again, and one for the rounding.
+  if (context.cruise_ticks > 0) {
+    float ahead = aircraft->taxi_path_.GetDistanceToRouteEnd();
+    ahead = std::min(ahead, aircraft->DistanceToNextHold() + aircraft->length_ / 2);
+    if (!aircraft->clearance_of_take_off_received_) {
+      float break_distance = abs(aircraft->Speed() * aircraft->Speed() / 2 / aircraft->soft_ground_deacceleration_);
+      if (aircraft->taxi_path_.Size() == 1) {
+        ahead = std::min(ahead, aircraft->taxi_path_.GetDistanceToRouteEnd() - break_distance);
       }
+      if (aircraft->next_hold_type_ != HoldPointType::NOTSET) {
+        ahead = std::min(ahead, aircraft->DistanceToNextHold() - break_distance - aircraft->length_ / 2);
+      }
+    }
+    int ticks = dist > 0 ? int(std::min(ahead / dist, float(INT_MAX / 2))) - 2 : 0;
+    context.cruise_ticks = std::max(std::min(context.cruise_ticks, ticks), 0);
+    if (aircraft->GetRoute()->GetNumOfOccupants() != 1 || !aircraft->IsLeaderLinkCurrent()) {
+      context.cruise_ticks = 0;
     }
   }
   // 4. return
-  return state_name_;
+  return id_;
 }
 
-void MaintainSpeedState::Exit() {
-  panel_->TurnOffManualTaxiHold(aircraft_);
+void MaintainSpeedState::Exit(StateContext& context) const {
+  const std::shared_ptr<Aircraft>& aircraft = context.aircraft;
+  context.observer->OnManualTaxiHoldAvailable(aircraft, false);
 }
 
-StopState::StopState(std::shared_ptr<Aircraft> aircraft,
-                     std::shared_ptr<BannerPanel> panel)
-  : State(aircraft, panel) {
-  state_name_ = "Stop";
+void MaintainSpeedState::PlanSpeedProfile(StateContext& context) const {
+  const std::shared_ptr<Aircraft>& aircraft = context.aircraft;
+  aircraft->taxi_path_.PlanSpeedProfile(aircraft->Speed(),
+                                         aircraft->soft_ground_acceleration_,
+                                         -aircraft->soft_ground_deacceleration_,
+                                         !aircraft->clearance_of_take_off_received_);
+  context.planned_with_take_off_clearance = aircraft->clearance_of_take_off_received_;
+  context.replan_needed = false;
 }
 
-std::string StopState::Entry() {
-  return state_name_;
+StopState::StopState()
+  : State(STOP, "Stop") {
 }
 
-std::string StopState::Update(float dt) {
-  // Banner
-  auto banner = panel_->GetBanner(aircraft_);
-  banner->SetText(aircraft_->GetName() + "|" + aircraft_->GetModel() + "|SPD:" + std::to_string(int(round(aircraft_->GetSpeed()))), 1);
-  banner->SetText("TAXI", 2);
-  banner->SetText(aircraft_->GetTaxiRoutesString(), 3);
+StateId StopState::Entry(StateContext& context) const {
+  const std::shared_ptr<Aircraft>& aircraft = context.aircraft;
+  aircraft->status_ = "TAXI";
+  return id_;
+}
 
+StateId StopState::Update(StateContext& context, float dt) const {
+  const std::shared_ptr<Aircraft>& aircraft = context.aircraft;
   // handle final stop
   // since already calculated within final stop range, just use brake to stop
   // after make full stop, transit to idlestate
-  aircraft_->acceleration_ = aircraft_->soft_ground_deacceleration_;
-  float dv = aircraft_->acceleration_ * dt;
-  float dist = (aircraft_->speed_ + dv / 2.0) * dt;
+  aircraft->Acceleration() = aircraft->soft_ground_deacceleration_;
+  return id_;
+}
 
-  aircraft_->speed_ += dv;
-  if (aircraft_->speed_ < 0) {
-    return "IdleState";
+StateId StopState::Move(StateContext& context, float dt) const {
+  const std::shared_ptr<Aircraft>& aircraft = context.aircraft;
+  if (aircraft->Speed() < 0) {
+    return StateId::IDLE;
   } else {
-    aircraft_->route_->ComputePosition(aircraft_, aircraft_->distance_on_route_, aircraft_->direction_on_route_, dist, &(aircraft_->route_), aircraft_->taxi_routes_);
-    aircraft_->sprite_.setPosition(ToSfmlPosition(aircraft_->route_->GetBreakOutPosition(
-                                          aircraft_->distance_on_route_)));
-    aircraft_->sprite_.setRotation(ToSfmlRotation(aircraft_->route_->GetRotation(
-                                          aircraft_->distance_on_route_, aircraft_->direction_on_route_)));
+    aircraft->MoveAlongTaxiPath(aircraft->GetDeltaDistance());
   }
-  return state_name_;
+  return id_;
 }
 
-void StopState::Exit() {
-  aircraft_->speed_ = 0;
-  aircraft_->acceleration_ = 0;
-  aircraft_->taxi_routes_.clear();
+void StopState::Exit(StateContext& context) const {
+  const std::shared_ptr<Aircraft>& aircraft = context.aircraft;
+  aircraft->Speed() = 0;
+  aircraft->Acceleration() = 0;
+  aircraft->taxi_path_.Clear();
 }
 
-IdleState::IdleState(std::shared_ptr<Aircraft> aircraft,
-                     std::shared_ptr<BannerPanel> panel)
-  : State(aircraft, panel) {
-  state_name_ = "IdleState";
+IdleState::IdleState()
+  : State(IDLE, "IdleState") {
 }
 
-std::string IdleState::Entry() {
-  aircraft_->speed_ = 0;
-  aircraft_->acceleration_ = 0;
-  return state_name_;
+StateId IdleState::Entry(StateContext& context) const {
+  const std::shared_ptr<Aircraft>& aircraft = context.aircraft;
+  aircraft->status_ = "IDLE";
+  aircraft->Speed() = 0;
+  aircraft->Acceleration() = 0;
+  return id_;
 }
 
-std::string IdleState::Update(float dt) {
-  auto banner = panel_->GetBanner(aircraft_);
-  banner->SetText(aircraft_->GetName() + "|" + aircraft_->GetModel() + "|SPD:" + std::to_string(int(round(aircraft_->GetSpeed()))), 1);
-  banner->SetText("IDLE", 2);
-  banner->SetText(aircraft_->GetTaxiRoutesString(), 3);
-
-  if (aircraft_->gate_ && !aircraft_->request_of_runway_sent_) {
-    timer_ += dt;
-    if (timer_ > aircraft_->max_time_at_gate_) {
-      return "RequestRunway";
+StateId IdleState::Update(StateContext& context, float dt) const {
+  const std::shared_ptr<Aircraft>& aircraft = context.aircraft;
+  if (aircraft->gate_ && !aircraft->request_of_runway_sent_) {
+    context.timer += dt;
+    if (context.timer > aircraft->max_time_at_gate_) {
+      return StateId::REQUEST_RUNWAY;
     }
+    // parked, nothing happens before the runway request
+    context.sleep = std::max(aircraft->max_time_at_gate_ - context.timer, 0.0f);
+    return id_;
   }
-  if (aircraft_->request_of_take_off_sent_) {
-    if (aircraft_->clearance_of_line_up_received_ && !aircraft_->GetTaxiRoutes().empty()) {
-      return "MaintainSpeed";
+  if (aircraft->request_of_take_off_sent_) {
+    if (aircraft->clearance_of_line_up_received_ && !aircraft->GetTaxiRoutes().Empty()) {
+      return StateId::MAINTAIN_SPEED;
     }
-    if (aircraft_->clearance_of_take_off_received_) {
-      return "TakeOff";
+    if (aircraft->clearance_of_take_off_received_) {
+      return StateId::TAKE_OFF;
     }
   }
+  // waits for the clearances
+  context.sleep = SLEEP_UNTIL_TOLD;
 
-  return state_name_;
+  return id_;
 }
 
-void IdleState::Exit() {
-  timer_ = 0;
+RequestRunwayState::RequestRunwayState()
+  : State(REQUEST_RUNWAY, "RequestRunway") {
 }
 
-RequestRunwayState::RequestRunwayState(std::shared_ptr<Aircraft> aircraft,
-                                       std::shared_ptr<BannerPanel> panel)
-  : State(aircraft, panel) {
-  state_name_ = "RequestRunway";
+StateId RequestRunwayState::Entry(StateContext& context) const {
+  const std::shared_ptr<Aircraft>& aircraft = context.aircraft;
+  aircraft->request_of_runway_sent_ = true;
+  aircraft->take_off_runway_assigned_ = false;
+  context.observer->OnRunwayRequested(aircraft);
+  return id_;
 }
 
-std::string RequestRunwayState::Entry() {
-  auto banner = panel_->GetBanner(aircraft_);
-  banner->SetText("", 3);
-  aircraft_->request_of_runway_sent_ = true;
-  aircraft_->take_off_runway_assigned_ = false;
-  panel_->RequestRunway(aircraft_);
-  return state_name_;
-}
-
-std::string RequestRunwayState::Update(float dt) {
-  if (aircraft_->take_off_runway_assigned_) {
-    return "RequestPushBack";
+StateId RequestRunwayState::Update(StateContext& context, float dt) const {
+  const std::shared_ptr<Aircraft>& aircraft = context.aircraft;
+  if (aircraft->take_off_runway_assigned_) {
+    return StateId::REQUEST_PUSH_BACK;
   }
-  return state_name_;
+  context.sleep = SLEEP_UNTIL_TOLD;
+  return id_;
 }
 
-RequestPushBackState::RequestPushBackState(std::shared_ptr<Aircraft> aircraft,
-                                           std::shared_ptr<BannerPanel> panel)
-  : State(aircraft, panel) {
-  state_name_ = "RequestPushBack";
+RequestPushBackState::RequestPushBackState()
+  : State(REQUEST_PUSH_BACK, "RequestPushBack") {
 }
 
-std::string RequestPushBackState::Entry() {
-  aircraft_->request_of_push_back_sent_ = true;
-  aircraft_->clearance_of_push_back_received_ = false;
-  panel_->RequestPushBack(aircraft_);
-  return state_name_;
+StateId RequestPushBackState::Entry(StateContext& context) const {
+  const std::shared_ptr<Aircraft>& aircraft = context.aircraft;
+  aircraft->request_of_push_back_sent_ = true;
+  aircraft->clearance_of_push_back_received_ = false;
+  context.observer->OnPushBackRequested(aircraft);
+  return id_;
 }
 
-std::string RequestPushBackState::Update(float dt) {
-  if (aircraft_->clearance_of_push_back_received_) {
-    return "PushBack";
+StateId RequestPushBackState::Update(StateContext& context, float dt) const {
+  const std::shared_ptr<Aircraft>& aircraft = context.aircraft;
+  if (aircraft->clearance_of_push_back_received_) {
+    return StateId::PUSH_BACK;
   }
-  return state_name_;
+  context.sleep = SLEEP_UNTIL_TOLD;
+  return id_;
 }
 
-PushBackState::PushBackState(std::shared_ptr<Aircraft> aircraft, std::shared_ptr<BannerPanel> panel)
-  : State(aircraft, panel) {
-  state_name_ = "PushBack";
+PushBackState::PushBackState()
+  : State(PUSH_BACK, "PushBack") {
 }
 
-std::string PushBackState::Entry() {
+StateId PushBackState::Entry(StateContext& context) const {
+  const std::shared_ptr<Aircraft>& aircraft = context.aircraft;
   // setup push back route;
-  std::list<std::string> push_back_routes;
-  push_back_routes.push_back(aircraft_->gate_->GetName());
-  push_back_routes.push_back(static_cast<Gate*>(aircraft_->gate_)->GetPushBackRoute(aircraft_->take_off_runway_)->GetName());
-  aircraft_->SetTaxiRoutes(push_back_routes);
-  aircraft_->direction_on_route_ = !aircraft_->direction_on_route_;
-  push_back_speed_ = KnotsToMetersPerSecond(aircraft_->gate_->GetTaxiSpeedLimit());
-  // setup panel
-  return state_name_;
-}
-
-std::string PushBackState::Update(float dt) {
-  // 1. update banner
-  auto banner = panel_->GetBanner(aircraft_);
-  banner->SetText(aircraft_->GetName() + "|" + aircraft_->GetModel() + "|SPD:" + std::to_string(int(round(aircraft_->GetSpeed()))), 1);
-  banner->SetText("PUSH_BACK", 2);
-  banner->SetText(aircraft_->GetTaxiRoutesString(), 3);
-
+  TaxiRoute push_back_routes;
+  push_back_routes.PushBack(aircraft->gate_);
+  push_back_routes.PushBack(static_cast<Gate*>(aircraft->gate_)->GetPushBackRoute(aircraft->take_off_runway_));
+  aircraft->SetDirectionOnRoute(!aircraft->GetDirectionOnRoute());
+  aircraft->SetTaxiRoutes(push_back_routes);
+  context.push_back_speed = KnotsToMetersPerSecond(aircraft->gate_->GetTaxiSpeedLimit());
+  aircraft->status_ = "PUSH_BACK";
+  return id_;
+}
+
+StateId PushBackState::Update(StateContext& context, float dt) const {
+  const std::shared_ptr<Aircraft>& aircraft = context.aircraft;
   // 2. update dynamics
-  aircraft_->acceleration_ = aircraft_->DetermineAcceleration(
-                                 push_back_speed_, dt,
-                                 aircraft_->soft_ground_acceleration_,
-                                 aircraft_->soft_ground_deacceleration_);
-
-  // 2. update speed and distance
-  float dv = aircraft_->acceleration_ * dt;
-  float dist = (aircraft_->speed_ + dv / 2.0) * dt;
-  aircraft_->speed_ += dv;
+  aircraft->Acceleration() = aircraft->DetermineAcceleration(
+                                 context.push_back_speed, dt,
+                                 aircraft->soft_ground_acceleration_,
+                                 aircraft->soft_ground_deacceleration_);
+  return id_;
+}
+
+StateId PushBackState::Move(StateContext& context, float dt) const {
+  const std::shared_ptr<Aircraft>& aircraft = context.aircraft;
   // 3. update position
-  aircraft_->route_->ComputePosition(aircraft_, aircraft_->distance_on_route_, aircraft_->direction_on_route_, dist, &(aircraft_->route_), aircraft_->taxi_routes_);
-  aircraft_->sprite_.setPosition(ToSfmlPosition(aircraft_->route_->GetBreakOutPosition(
-                                         aircraft_->distance_on_route_)));
-  aircraft_->sprite_.setRotation(ToSfmlRotation(aircraft_->route_->GetRotation(
-                                         aircraft_->distance_on_route_, aircraft_->direction_on_route_) + 180));
+  aircraft->MoveAlongTaxiPath(aircraft->GetDeltaDistance());
+  // pushed back tail first
+  aircraft->heading_ += 180;
   // 3.5 Update current_route if needed
-  if (aircraft_->taxi_routes_.empty()) {
-    return "MaintainSpeed";
+  if (aircraft->taxi_path_.Empty()) {
+    return StateId::MAINTAIN_SPEED;
   }
 
-  return state_name_;
+  return id_;
 }
 
-void PushBackState::Exit() {
+void PushBackState::Exit(StateContext& context) const {
+  const std::shared_ptr<Aircraft>& aircraft = context.aircraft;
   // free gate
-  static_cast<Gate*>(aircraft_->gate_)->Free(aircraft_);
-
-  // set banner
+  static_cast<Gate*>(aircraft->gate_)->Free(aircraft);
 
   // set position for taxi to runway
   // 1.get push back last route
-  auto push_back_route = static_cast<Gate*>(aircraft_->gate_)->GetPushBackRoute(aircraft_->take_off_runway_);
+  auto push_back_route = static_cast<Gate*>(aircraft->gate_)->GetPushBackRoute(aircraft->take_off_runway_);
   // 2.get connection route
   auto next_routes = push_back_route->GetConnectedRouteBreakOutAt(push_back_route->GetLength());
-  if (next_routes.back() == aircraft_->gate_) {
+  if (next_routes.back() == aircraft->gate_) {
     next_routes = push_back_route->GetConnectedRouteBreakOutAt(0);
   }
   std::string first_taxi_to_runway_route_name = next_routes.back()->GetName();
   // This line was used to be the first line in this function. Still can be the first if caching search result of taxi to runway from gate.
-  // std::string first_taxi_to_runway_route_name = static_cast<Gate*>(aircraft_->gate_)->GetTaxiToRunwayList(aircraft_->take_off_runway_).front();
-  auto break_in_distance = aircraft_->route_->GetConnectionInfo(first_taxi_to_runway_route_name).distance_to_break_in;
-  auto break_in_direction = aircraft_->route_->GetConnectionInfo(first_taxi_to_runway_route_name).positive_entering_next_piece;
-  auto next_route = aircraft_->route_->GetConnectionInfo(first_taxi_to_runway_route_name).next_piece;
-  aircraft_->SetGroundRoute(next_route, !break_in_direction, break_in_distance);
+  // std::string first_taxi_to_runway_route_name = static_cast<Gate*>(aircraft->gate_)->GetTaxiToRunwayList(aircraft->take_off_runway_).front();
+  auto break_in_distance = aircraft->GetRoute()->GetConnectionInfo(first_taxi_to_runway_route_name).distance_to_break_in;
+  auto break_in_direction = aircraft->GetRoute()->GetConnectionInfo(first_taxi_to_runway_route_name).positive_entering_next_piece;
+  auto next_route = aircraft->GetRoute()->GetConnectionInfo(first_taxi_to_runway_route_name).next_piece;
+  aircraft->SetGroundRoute(next_route, !break_in_direction, break_in_distance);
 
   // set taxi_routes
-  // aircraft_->SetTaxiRoutes(static_cast<Gate*>(aircraft_->gate_)->GetTaxiToRunwayList(aircraft_->take_off_runway_));
-  auto banner = panel_->GetBanner(aircraft_);
-  auto airport = banner->GetAirport();
-  HoldPoint line_up_point = airport->GetLineUpPoint(aircraft_->take_off_runway_);
-  aircraft_->SetTaxiRoutes(airport->GetRoute(aircraft_->GetRoute(), aircraft_->GetDirectionOnRoute(),
-                                               aircraft_->GetDistanceOnRoute(),
+  // aircraft->SetTaxiRoutes(static_cast<Gate*>(aircraft->gate_)->GetTaxiToRunwayList(aircraft->take_off_runway_));
+  auto airport = aircraft->airport_;
+  HoldPoint line_up_point = airport->GetLineUpPoint(aircraft->take_off_runway_);
+  aircraft->SetTaxiRoutes(airport->GetRoute(aircraft->GetRoute(), aircraft->GetDirectionOnRoute(),
+                                               aircraft->GetDistanceOnRoute(),
                                                line_up_point.route, line_up_point.direction, line_up_point.distance_on_route));
 }
 
-TakeOffState::TakeOffState(std::shared_ptr<Aircraft> aircraft,
-                           std::shared_ptr<BannerPanel> panel)
-  : State(aircraft, panel) {
-  state_name_ = "TakeOff";
+TakeOffState::TakeOffState()
+  : State(TAKE_OFF, "TakeOff"),
+    take_off_speed_(KnotsToMetersPerSecond(170)) {
 }
 
-std::string TakeOffState::Entry() {
+StateId TakeOffState::Entry(StateContext& context) const {
+  const std::shared_ptr<Aircraft>& aircraft = context.aircraft;
   // set groundroute
-  aircraft_->taxi_routes_.push_back(aircraft_->route_->GetName());
-  aircraft_->taxi_routes_.push_back(aircraft_->take_off_runway_.substr(1,aircraft_->take_off_runway_.size()-1));
-  //
-  return state_name_;
-}
-
-std::string TakeOffState::Update(float dt) {
-  auto banner = panel_->GetBanner(aircraft_);
-  banner->SetText(aircraft_->GetName() + "|" + aircraft_->GetModel() + "|SPD:" + std::to_string(int(round(aircraft_->GetSpeed()))), 1);
-  banner->SetText("TAKE_OFF", 2);
-  banner->SetText(aircraft_->GetTaxiRoutesString(), 3);
-
-  float take_off_speed = KnotsToMetersPerSecond(170);
-
-  aircraft_->acceleration_ = aircraft_->DetermineAcceleration(take_off_speed, dt,
-                                            aircraft_->max_ground_acceleration_,
-                                            aircraft_->soft_ground_deacceleration_);
-  float dv = aircraft_->acceleration_ * dt;
-  float dist = (aircraft_->speed_ + dv / 2.0) * dt;
-  aircraft_->speed_ += dv;
+  auto airport = aircraft->airport_;
+  TaxiRoute take_off_routes;
+  take_off_routes.PushBack(aircraft->GetRoute());
+  take_off_routes.PushBack(airport->GetRoutePtr(aircraft->take_off_runway_.substr(1,aircraft->take_off_runway_.size()-1)));
+  aircraft->SetTaxiRoutes(take_off_routes);
+  aircraft->status_ = "TAKE_OFF";
+  return id_;
+}
+
+StateId TakeOffState::Update(StateContext& context, float dt) const {
+  const std::shared_ptr<Aircraft>& aircraft = context.aircraft;
+  aircraft->Acceleration() = aircraft->DetermineAcceleration(take_off_speed_, dt,
+                                            aircraft->max_ground_acceleration_,
+                                            aircraft->soft_ground_deacceleration_);
+  return id_;
+}
+
+StateId TakeOffState::Move(StateContext& context, float dt) const {
+  const std::shared_ptr<Aircraft>& aircraft = context.aircraft;
   // update position
-  aircraft_->route_->ComputePosition(aircraft_, aircraft_->distance_on_route_, aircraft_->direction_on_route_,
-                          dist, &aircraft_->route_, aircraft_->taxi_routes_);
-  aircraft_->sprite_.setPosition(ToSfmlPosition(aircraft_->route_->GetBreakOutPosition(
-                                       aircraft_->distance_on_route_)));
-  aircraft_->sprite_.setRotation(ToSfmlRotation(aircraft_->route_->GetRotation(
-                                       aircraft_->distance_on_route_, aircraft_->direction_on_route_)));
-
-  if (aircraft_->speed_ >= take_off_speed) {
-    return "Leaving";
+  aircraft->MoveAlongTaxiPath(aircraft->GetDeltaDistance());
+
+  if (aircraft->Speed() >= take_off_speed_) {
+    return StateId::LEAVING;
   }
-  return state_name_;
+  return id_;
 }
 
-HoldState::HoldState(std::shared_ptr<Aircraft> aircraft,
-                           std::shared_ptr<BannerPanel> panel)
-  : State(aircraft, panel) {
-  state_name_ = "Hold";
+HoldState::HoldState()
+  : State(HOLD, "Hold") {
 }
 
-std::string HoldState::Entry() {
-  if (aircraft_->next_hold_type_ == HoldPointType::TAKEOFF) {
-    panel_->RequestTakeOff(aircraft_);
-    aircraft_->request_of_take_off_sent_ = true;
-    aircraft_->acceleration_ = aircraft_->soft_ground_deacceleration_;
-    aircraft_->next_hold_type_ = HoldPointType::NOTSET;
-    return state_name_;
+StateId HoldState::Entry(StateContext& context) const {
+  const std::shared_ptr<Aircraft>& aircraft = context.aircraft;
+  if (aircraft->next_hold_type_ == HoldPointType::TAKEOFF) {
+    context.observer->OnTakeOffRequested(aircraft);
+    aircraft->request_of_take_off_sent_ = true;
+    aircraft->Acceleration() = aircraft->soft_ground_deacceleration_;
+    aircraft->next_hold_type_ = HoldPointType::NOTSET;
+    return id_;
   }
-  return state_name_;
+  return id_;
+}
+
+StateId HoldState::Update(StateContext& context, float dt) const {
+  // keeps braking with the acceleration set on entry
+  return id_;
 }
 
-std::string HoldState::Update(float dt) {
+StateId HoldState::Move(StateContext& context, float dt) const {
+  const std::shared_ptr<Aircraft>& aircraft = context.aircraft;
   // after hold clearance, either transit to maintain speed(hold before align runway, hold for traffic, hold for cross runway) or take off(hold align runway)
-  float dv = aircraft_->acceleration_ * dt;
-  float dist = (aircraft_->speed_ + dv / 2.0) * dt;
-  aircraft_->distance_to_next_hold_ -= dist;
-  aircraft_->speed_ += dv;
-  if (aircraft_->speed_ < 0) {
-    return "IdleState";
+  float dist = aircraft->GetDeltaDistance();
+  aircraft->DistanceToNextHold() -= dist;
+  if (aircraft->Speed() < 0) {
+    return StateId::IDLE;
   } else {
-    aircraft_->route_->ComputePosition(aircraft_, aircraft_->distance_on_route_, aircraft_->direction_on_route_, dist, &(aircraft_->route_), aircraft_->taxi_routes_);
-    aircraft_->sprite_.setPosition(ToSfmlPosition(aircraft_->route_->GetBreakOutPosition(
-                                          aircraft_->distance_on_route_)));
-    aircraft_->sprite_.setRotation(ToSfmlRotation(aircraft_->route_->GetRotation(
-                                          aircraft_->distance_on_route_, aircraft_->direction_on_route_)));
+    aircraft->MoveAlongTaxiPath(dist);
   }
-  if (aircraft_->clearance_of_line_up_received_) {
-    return "MaintainSpeed";
+  if (aircraft->clearance_of_line_up_received_) {
+    return StateId::MAINTAIN_SPEED;
   }
-  if (aircraft_->clearance_of_take_off_received_) {
-    return "TakeOff";
+  if (aircraft->clearance_of_take_off_received_) {
+    return StateId::TAKE_OFF;
   }
-  return state_name_;
+  return id_;
 }
 
-LeavingState::LeavingState(std::shared_ptr<Aircraft> aircraft,
-                           std::shared_ptr<BannerPanel> panel)
-  : State(aircraft, panel) {
-  state_name_ = "Leaving";
+LeavingState::LeavingState()
+  : State(LEAVING, "Leaving") {
 }
 
-std::string LeavingState::Update(float dt) {
-  return state_name_;
+StateId LeavingState::Update(StateContext& context, float dt) const {
+  return id_;
 }
 
-std::string LeavingState::Entry() {
-  panel_->RemoveBanner(aircraft_);
-  aircraft_->Deactivate();
-  aircraft_->Delete();
-  return state_name_;
+StateId LeavingState::Entry(StateContext& context) const {
+  const std::shared_ptr<Aircraft>& aircraft = context.aircraft;
+  // gone from the ground, it must not be seen as traffic any more
+  aircraft->GetRoute()->ClearAircraft(aircraft);
+  aircraft->ClearLeaderLink();
+  aircraft->Deactivate();
+  aircraft->Delete();
+  return id_;
 }
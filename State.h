@@ -1,123 +1,185 @@
 #ifndef STATE_H
 #define STATE_H
 
-#include "SFML/Graphics.hpp"
 #include <memory>
 
 class Aircraft;
 class RouteBase;
-class BannerPanel;
+class SimulationObserver;
+
+// Seconds from the first update of an aircraft to its touch down
+#define BEFORE_LANDING_INTERVAL 120
+// StateContext::sleep of a state waiting for the controller
+#define SLEEP_UNTIL_TOLD -1
+
+enum StateId {
+  INITIAL,
+  TOUCH_DOWN,
+  MAINTAIN_SPEED,
+  STOP,
+  IDLE,
+  REQUEST_RUNWAY,
+  REQUEST_PUSH_BACK,
+  PUSH_BACK,
+  TAKE_OFF,
+  HOLD,
+  LEAVING,
+  NUM_OF_STATES,
+};
+
+// What the states keep for one aircraft. The states themselves hold nothing
+// per aircraft, one instance of each serves every aircraft.
+struct StateContext {
+  std::shared_ptr<Aircraft> aircraft;
+  SimulationObserver* observer;
+
+  // seconds counted by the current state, 0 on entry
+  float timer = 0;
+  // set by Update: the state has nothing to do for this many seconds, or
+  // SLEEP_UNTIL_TOLD, unless the aircraft is told something. Its updates
+  // can be skipped meanwhile. Only asked for by states that do not move.
+  float sleep = 0;
+  // set by Update of a moving state: the updates of this many ticks after
+  // this one would decide the same, as long as the routes ahead are
+  // occupied as they are. Move cuts it down to the ticks none of its own
+  // checks can fire in, or to 0. The machine then has the aircraft cruise,
+  // see Aircraft::StartCruise, and skips Decide, Commit and Move that long.
+  // Reset by a transition or the aircraft being told something.
+  int cruise_ticks = 0;
+
+  // MaintainSpeed
+  RouteBase* current_route = nullptr;
+  // the profile stops at hold points only without take off clearance
+  bool planned_with_take_off_clearance = false;
+  // a stop of the profile was taken over by a manual hold, plan again on resume
+  bool replan_needed = false;
+
+  // PushBack
+  float push_back_speed = 0;
+};
 
 class State {
   public:
-    State(std::shared_ptr<Aircraft> aircraft, std::shared_ptr<BannerPanel> panel)
-     : aircraft_(aircraft), panel_(panel) {};
-
-    virtual std::string Entry() { return state_name_; };
-    virtual std::string Update(float dt) { return state_name_; };
-    virtual void Exit() {};
-    virtual std::string GetStateName() { return state_name_; }
+    State(StateId id, const char* state_name) : id_(id), state_name_(state_name) {};
+    virtual ~State() {};
+
+    virtual StateId Entry(StateContext& context) const { return id_; };
+    // Decide for this tick. A moving state only sets the acceleration here,
+    // the kinematics table integrates every moving aircraft at once.
+    // Aircraft decide in parallel: only read other aircraft and the airport,
+    // only write this aircraft. Anything else goes to Entry, Exit or Move.
+    virtual StateId Update(StateContext& context, float dt) const { return id_; };
+    // Whether the aircraft is integrated while in this state
+    virtual bool IsMoving() const { return false; }
+    // Called after the integration of the tick, the speed is already the
+    // new one. Move the aircraft by the distance travelled and check where
+    // that leads.
+    virtual StateId Move(StateContext& context, float dt) const { return id_; };
+    virtual void Exit(StateContext& context) const {};
+
+    StateId GetStateId() const { return id_; }
+    const char* GetStateName() const { return state_name_; }
+
+    // The shared instance of every state
+    static const State* Get(StateId id);
 
   protected:
-    std::shared_ptr<Aircraft> aircraft_;
-    std::shared_ptr<BannerPanel> panel_;
-    std::string state_name_ = "";
+    const StateId id_;
+    const char* state_name_;
 };
 
 class InitialState : public State {
   public:
-    InitialState(std::shared_ptr<Aircraft> aircraft, std::shared_ptr<BannerPanel> panel);
-    std::string Entry() override;
-    std::string Update(float dt) override;
-  private:
-    float timer_ = 0;
-    float before_landing_interval = 120; // 2 mins before landing
+    InitialState();
+    StateId Entry(StateContext& context) const override;
+    StateId Update(StateContext& context, float dt) const override;
 };
 
 class TouchDownState : public State {
   public:
-    TouchDownState(std::shared_ptr<Aircraft> aircraft, std::shared_ptr<BannerPanel> panel);
-    std::string Entry() override;
-  private:
-
+    TouchDownState();
+    StateId Entry(StateContext& context) const override;
 };
 
 class MaintainSpeedState : public State {
   public:
-    MaintainSpeedState(std::shared_ptr<Aircraft> aircraft, std::shared_ptr<BannerPanel> panel);
-    std::string Update(float dt) override;
-    std::string Entry() override;
-    void Exit() override;
+    MaintainSpeedState();
+    StateId Update(StateContext& context, float dt) const override;
+    bool IsMoving() const override { return true; }
+    StateId Move(StateContext& context, float dt) const override;
+    StateId Entry(StateContext& context) const override;
+    void Exit(StateContext& context) const override;
 
   private:
-    RouteBase* current_route_ = nullptr;
-    RouteBase* next_route_ = nullptr;
-    float current_route_speed_limit_ = 0;
-    float next_route_speed_limit_ = 0;
-
+    // Plan the speed profile of the rest of the taxi path from the current speed
+    void PlanSpeedProfile(StateContext& context) const;
 };
 
 class StopState : public State {
   public:
-    StopState(std::shared_ptr<Aircraft> aircraft, std::shared_ptr<BannerPanel> panel);
-    std::string Entry() override;
-    std::string Update(float dt) override;
-    void Exit() override;
+    StopState();
+    StateId Entry(StateContext& context) const override;
+    StateId Update(StateContext& context, float dt) const override;
+    bool IsMoving() const override { return true; }
+    StateId Move(StateContext& context, float dt) const override;
+    void Exit(StateContext& context) const override;
 };
 
 class IdleState : public State {
   public:
-    IdleState(std::shared_ptr<Aircraft> aircraft, std::shared_ptr<BannerPanel> panel);
-    std::string Update(float dt) override;
-    std::string Entry() override;
-    void Exit() override;
-  private:
-    float timer_ = 0;
+    IdleState();
+    StateId Update(StateContext& context, float dt) const override;
+    StateId Entry(StateContext& context) const override;
 };
 
 class RequestRunwayState : public State {
   public:
-    RequestRunwayState(std::shared_ptr<Aircraft> aircraft, std::shared_ptr<BannerPanel> panel);
-    std::string Update(float dt) override;
-    std::string Entry() override;
+    RequestRunwayState();
+    StateId Update(StateContext& context, float dt) const override;
+    StateId Entry(StateContext& context) const override;
 };
 
 class RequestPushBackState : public State {
   public:
-    RequestPushBackState(std::shared_ptr<Aircraft> aircraft, std::shared_ptr<BannerPanel> panel);
-    std::string Update(float dt) override;
-    std::string Entry() override;
+    RequestPushBackState();
+    StateId Update(StateContext& context, float dt) const override;
+    StateId Entry(StateContext& context) const override;
 };
 
 class PushBackState : public State {
   public:
-    PushBackState(std::shared_ptr<Aircraft> aircraft, std::shared_ptr<BannerPanel> panel);
-    std::string Update(float dt) override;
-    std::string Entry() override;
-    void Exit() override;
-
-  private:
-    float push_back_speed_ = 0;
+    PushBackState();
+    StateId Update(StateContext& context, float dt) const override;
+    bool IsMoving() const override { return true; }
+    StateId Move(StateContext& context, float dt) const override;
+    StateId Entry(StateContext& context) const override;
+    void Exit(StateContext& context) const override;
 };
 
 class TakeOffState : public State {
   public:
-    TakeOffState(std::shared_ptr<Aircraft> aircraft, std::shared_ptr<BannerPanel> panel);
-    std::string Update(float dt) override;
-    std::string Entry() override;
+    TakeOffState();
+    StateId Update(StateContext& context, float dt) const override;
+    bool IsMoving() const override { return true; }
+    StateId Move(StateContext& context, float dt) const override;
+    StateId Entry(StateContext& context) const override;
+  private:
+    const float take_off_speed_;
 };
 
 class HoldState : public State {
   public:
-    HoldState(std::shared_ptr<Aircraft> aircraft, std::shared_ptr<BannerPanel> panel);
-    std::string Update(float dt) override;
-    std::string Entry() override;
+    HoldState();
+    StateId Update(StateContext& context, float dt) const override;
+    bool IsMoving() const override { return true; }
+    StateId Move(StateContext& context, float dt) const override;
+    StateId Entry(StateContext& context) const override;
 };
 
 class LeavingState : public State {
   public:
-    LeavingState(std::shared_ptr<Aircraft> aircraft, std::shared_ptr<BannerPanel> panel);
-    std::string Update(float dt) override;
-    std::string Entry() override;
+    LeavingState();
+    StateId Update(StateContext& context, float dt) const override;
+    StateId Entry(StateContext& context) const override;
 };
 #endif // STATE_H
@@ -1,63 +1,100 @@
 #include "StateMachine.h"
+#include <algorithm>
 #include <iostream>
-#include "BannerPanel.h"
+#include "Aircraft.h"
+#include "SimulationObserver.h"
 
-StateMachine::StateMachine(std::shared_ptr<Aircraft> aircraft, std::shared_ptr<BannerPanel> panel)
-  : aircraft_(aircraft),
-    panel_(panel) {
+StateMachine::StateMachine(std::shared_ptr<Aircraft> aircraft, SimulationObserver* observer,
+                            bool log_transitions)
+  : log_transitions_(log_transitions) {
+  context_.aircraft = aircraft;
+  context_.observer = observer;
+  TransitToState(StateId::INITIAL);
+}
 
-  panel_->CreateBanner(aircraft_);
+StateId StateMachine::GetCurrentStateId() const {
+  return current_state_id_;
+}
 
-  states_vector_.push_back(std::make_unique<InitialState>(InitialState(aircraft_, panel_)));
-  states_vector_.push_back(std::make_unique<TouchDownState>(TouchDownState(aircraft_, panel_)));
-  states_vector_.push_back(std::make_unique<MaintainSpeedState>(MaintainSpeedState(aircraft_, panel_)));
-  states_vector_.push_back(std::make_unique<StopState>(StopState(aircraft_, panel_)));
-  states_vector_.push_back(std::make_unique<IdleState>(IdleState(aircraft_, panel_)));
-  states_vector_.push_back(std::make_unique<RequestRunwayState>(RequestRunwayState(aircraft_, panel_)));
-  states_vector_.push_back(std::make_unique<RequestPushBackState>(RequestPushBackState(aircraft_, panel_)));
-  states_vector_.push_back(std::make_unique<PushBackState>(PushBackState(aircraft_, panel_)));
-  states_vector_.push_back(std::make_unique<TakeOffState>(TakeOffState(aircraft_, panel_)));
-  states_vector_.push_back(std::make_unique<HoldState>(HoldState(aircraft_, panel_)));
-  states_vector_.push_back(std::make_unique<LeavingState>(LeavingState(aircraft_, panel_)));
+void StateMachine::Update(float dt) {
+  Decide(dt);
+  Commit();
+}
 
-  states_name_to_id_["Initial"] = 0;
-  states_name_to_id_["TouchDown"] = 1;
-  states_name_to_id_["MaintainSpeed"] = 2;
-  states_name_to_id_["Stop"] = 3;
-  states_name_to_id_["IdleState"] = 4;
-  states_name_to_id_["RequestRunway"] = 5;
-  states_name_to_id_["RequestPushBack"] = 6;
-  states_name_to_id_["PushBack"] = 7;
-  states_name_to_id_["TakeOff"] = 8;
-  states_name_to_id_["Hold"] = 9;
-  states_name_to_id_["Leaving"] = 10;
+void StateMachine::Decide(float dt) {
+  if (context_.aircraft->IsCruising()) {
+    return;
+  }
+  decided_state_id_ = State::Get(current_state_id_)->Update(context_, dt);
+}
 
-  current_state_id_ = 0;
-  TransitToState("Initial");
+void StateMachine::Interrupt() {
+  context_.cruise_ticks = 0;
+  context_.aircraft->EndCruise();
 }
 
-int StateMachine::GetCurrentStateId() {
-  return current_state_id_;
+void StateMachine::Commit() {
+  if (context_.aircraft->IsCruising()) {
+    return;
+  }
+  moving_ = false;
+  if (current_state_id_ != decided_state_id_) {
+    TransitToState(decided_state_id_);
+  } else {
+    moving_ = State::Get(current_state_id_)->IsMoving();
+  }
+  context_.aircraft->SetMoving(moving_);
 }
 
-void StateMachine::Update(float dt) {
-  std::string next_state_name = states_vector_[current_state_id_]->Update(dt);
-  auto next_state_id = states_name_to_id_[next_state_name];
+void StateMachine::Move(float dt) {
+  if (!moving_ || context_.aircraft->IsCruising()) {
+    return;
+  }
+  StateId next_state_id = State::Get(current_state_id_)->Move(context_, dt);
   if (current_state_id_ != next_state_id) {
-    TransitToState(next_state_name);
+    TransitToState(next_state_id);
+  } else if (context_.cruise_ticks > 0) {
+    context_.aircraft->StartCruise(dt);
+  }
+}
+
+int StateMachine::Cruise() {
+  int cruise_ticks = context_.cruise_ticks;
+  context_.cruise_ticks = 0;
+  return cruise_ticks;
+}
+
+int StateMachine::Sleep(float tick) {
+  float sleep = context_.sleep;
+  context_.sleep = 0;
+  if (moving_ || sleep == 0) {
+    return 0;
+  }
+  if (sleep < 0) {
+    return SLEEP_UNTIL_TOLD;
   }
+  // woken a tick early, the state times the last tick itself
+  return std::max(int(sleep / tick) - 1, 0);
+}
+
+void StateMachine::Wake(float seconds_slept) {
+  context_.timer += seconds_slept;
 }
 
 // TransitToState is called to trasit to a new state.
-void StateMachine::TransitToState(std::string next_state_name) {
-  states_vector_[current_state_id_]->Exit();
-  std::cout << aircraft_->GetName() << " Transit to " << next_state_name << std::endl;
-  auto next_state_id = states_name_to_id_[next_state_name];
+void StateMachine::TransitToState(StateId next_state_id) {
+  State::Get(current_state_id_)->Exit(context_);
+  const State* next_state = State::Get(next_state_id);
+  if (log_transitions_) {
+    std::cout << context_.aircraft->GetName() << " Transit to " << next_state->GetStateName() << std::endl;
+  }
   current_state_id_ = next_state_id;
-  next_state_name = states_vector_[current_state_id_]->Entry();
-  next_state_id = states_name_to_id_[next_state_name];
+  context_.timer = 0;
+  context_.sleep = 0;
+  context_.cruise_ticks = 0;
+  next_state_id = next_state->Entry(context_);
   if (next_state_id != current_state_id_) {
-    TransitToState(next_state_name);
+    TransitToState(next_state_id);
   }
 }
 
@@ -2,38 +2,59 @@
 #define STATEMACHINE_H
 
 #include <memory>
-#include <unordered_map>
-#include <vector>
 #include "State.h"
 
 class Aircraft;
-class BannerPanel;
-class State;
-class InitialState;
-class TouchDownState;
-class MaintainSpeedState;
-class StopState;
-class IdleState;
-class TakeOffState;
-class LeavingState;
+class SimulationObserver;
 
+// Drives one aircraft through the shared states. The machine only keeps the
+// current state and the context of the aircraft.
 class StateMachine
 {
   public:
-    StateMachine(std::shared_ptr<Aircraft> aircraft, std::shared_ptr<BannerPanel> panel);
+    // log_transitions prints every transition to std::cout
+    StateMachine(std::shared_ptr<Aircraft> aircraft, SimulationObserver* observer,
+                 bool log_transitions = true);
     ~StateMachine();
+    // Held by value in the aircraft list, moved when the list is reordered
+    StateMachine(StateMachine&&) = default;
+    StateMachine& operator=(StateMachine&&) = default;
 
+    // One tick is Update on every state machine, one Integrate of the
+    // kinematics table, then Move on every state machine.
     void Update(float dt);
-    int GetCurrentStateId();
-    void TransitToState(std::string new_state_name);
+    void Move(float dt);
+    // Update split in two. Decide runs the current state and keeps the state
+    // it asks for. It only writes the own aircraft, so the state machines
+    // can decide in parallel. Commit then transits, one machine after the
+    // other.
+    // A cruising machine skips Decide, Commit and Move, see StateContext.
+    void Decide(float dt);
+    void Commit();
+    // The aircraft was told something or its cruise is over, the cruise
+    // ends and the next Decide runs the state
+    void Interrupt();
+    StateId GetCurrentStateId() const;
+    void TransitToState(StateId next_state_id);
+    // After Commit: the ticks after this one the current state asked to be
+    // left alone for, SLEEP_UNTIL_TOLD to wait for the aircraft to be told
+    // something, 0 if none. The caller skips Decide, Commit and Move of the
+    // machine that long, then calls Wake. Asking again gives 0.
+    int Sleep(float tick);
+    // Back from Sleep, the seconds skipped count for the current state
+    void Wake(float seconds_slept);
+    // After Move: the ticks after this one the aircraft cruises for, 0 if
+    // it does not. The caller calls Interrupt once they are run, or earlier
+    // if the aircraft is told something. Asking again gives 0.
+    int Cruise();
 
   protected:
-    int current_state_id_;
-    std::vector<std::unique_ptr<State>> states_vector_;
-    std::unordered_map<std::string, int> states_name_to_id_;
-
-    std::shared_ptr<Aircraft> aircraft_;
-    std::shared_ptr<BannerPanel> panel_;
+    StateId current_state_id_ = StateId::INITIAL;
+    StateId decided_state_id_ = StateId::INITIAL;
+    // the current state moves this tick, it did not transit in Update
+    bool moving_ = false;
+    bool log_transitions_;
+    StateContext context_;
   private:
 };
 
@@ -0,0 +1,203 @@
+#include "TaxiGraph.h"
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <math.h>
+
+TaxiGraph::TaxiGraph()
+  : row_offsets_(1, 0) {
+}
+
+void TaxiGraph::Build(const std::vector<SegmentInfo>& segments) {
+  int n = segments.size();
+  row_offsets_.assign(n + 1, 0);
+  columns_.clear();
+  weights_.clear();
+
+  start_positions_.resize(n);
+  end_positions_.resize(n);
+  lengths_.resize(n);
+  for (int i = 0; i < n; i++) {
+    start_positions_[i] = segments[i].route->GetBreakOutPosition(segments[i].start_distance);
+    end_positions_[i] = segments[i].route->GetBreakOutPosition(segments[i].end_distance);
+    lengths_[i] = segments[i].length;
+  }
+
+  for (int i = 0; i < n; i++) {
+    for (auto id : segments[i].out_segment) {
+      if (id < 0 || id >= n) {
+        std::cout << "Out segment " << id << " of " << segments[i].name
+                  << " is not registered." << std::endl;
+        continue;
+      }
+      columns_.push_back(id);
+      weights_.push_back(segments[i].length);
+    }
+    row_offsets_[i + 1] = columns_.size();
+  }
+
+  // transpose: count in-degrees, prefix sum, then scatter
+  reverse_row_offsets_.assign(n + 1, 0);
+  for (auto c : columns_) {
+    reverse_row_offsets_[c + 1]++;
+  }
+  for (int i = 0; i < n; i++) {
+    reverse_row_offsets_[i + 1] += reverse_row_offsets_[i];
+  }
+  reverse_columns_.assign(columns_.size(), 0);
+  reverse_weights_.assign(columns_.size(), 0);
+  std::vector<int> fill(reverse_row_offsets_.begin(), reverse_row_offsets_.end() - 1);
+  for (int i = 0; i < n; i++) {
+    for (int e = RowBegin(i); e < RowEnd(i); e++) {
+      int slot = fill[columns_[e]]++;
+      reverse_columns_[slot] = i;
+      reverse_weights_[slot] = weights_[e];
+    }
+  }
+}
+
+float TaxiGraph::EstimateDistance(int node, int target) const {
+  if (node == target) {
+    return 0;
+  }
+  sf::Vector2f d = start_positions_[target] - end_positions_[node];
+  return lengths_[node] + sqrt(d.x * d.x + d.y * d.y);
+}
+
+RouteQuery::RouteQuery(const TaxiGraph* graph)
+  : graph_(nullptr) {
+  Bind(graph);
+}
+
+void RouteQuery::Bind(const TaxiGraph* graph) {
+  graph_ = graph;
+  if (!graph_) {
+    return;
+  }
+  int n = graph_->GetNumOfNodes();
+  if (int(stamp_.size()) < n) {
+    stamp_.assign(n, 0);
+    dist_.resize(n);
+    estimate_.resize(n);
+    from_.resize(n);
+    epoch_ = 0;
+  }
+  heap_.reserve(graph_->GetNumOfEdges() + 1);
+  path_.reserve(n);
+}
+
+void RouteQuery::NextEpoch() {
+  epoch_++;
+  if (epoch_ == 0) {
+    // wrapped around, old stamps could look valid again
+    std::fill(stamp_.begin(), stamp_.end(), 0);
+    epoch_ = 1;
+  }
+}
+
+bool RouteQuery::Search(int src, int dst, RouteSearchMode mode) {
+  path_.clear();
+  path_distance_ = 0;
+  num_of_expanded_nodes_ = 0;
+  if (!graph_) {
+    std::cout << "RouteQuery is not bound to a graph." << std::endl;
+    return false;
+  }
+  NextEpoch();
+  heap_.clear();
+  bool use_estimate = (mode == RouteSearchMode::ASTAR);
+
+  // Lazy deletion: a node may be pushed several times, stale entries are
+  // skipped when popped. Because stale nodes can be pushed again, A* also
+  // stays correct if the estimate is slightly inconsistent.
+  auto heap_compare = std::greater<HeapEntry>();
+  stamp_[src] = epoch_;
+  dist_[src] = 0;
+  estimate_[src] = use_estimate ? graph_->EstimateDistance(src, dst) : 0;
+  from_[src] = -1;
+  heap_.push_back({estimate_[src], 0, src});
+
+  bool found = false;
+  while (!heap_.empty()) {
+    std::pop_heap(heap_.begin(), heap_.end(), heap_compare);
+    HeapEntry top = heap_.back();
+    heap_.pop_back();
+    int u = top.node;
+    if (top.dist > dist_[u]) {
+      continue;
+    }
+    num_of_expanded_nodes_++;
+    if (u == dst) {
+      found = true;
+      break;
+    }
+    for (int e = graph_->RowBegin(u); e < graph_->RowEnd(u); e++) {
+      int v = graph_->Column(e);
+      float d = dist_[u] + graph_->Weight(e);
+      if (!IsTouched(v)) {
+        stamp_[v] = epoch_;
+        estimate_[v] = use_estimate ? graph_->EstimateDistance(v, dst) : 0;
+      } else if (d >= dist_[v]) {
+        continue;
+      }
+      dist_[v] = d;
+      from_[v] = u;
+      heap_.push_back({d + estimate_[v], d, v});
+      std::push_heap(heap_.begin(), heap_.end(), heap_compare);
+    }
+  }
+
+  if (!found) {
+    return false;
+  }
+  path_distance_ = dist_[dst];
+  for (int v = dst; v != -1; v = from_[v]) {
+    path_.push_back(v);
+  }
+  std::reverse(path_.begin(), path_.end());
+  return true;
+}
+
+void ShortestPathTree::Build(const TaxiGraph& graph, int destination) {
+  int n = graph.GetNumOfNodes();
+  destination_ = destination;
+  dist_.assign(n, std::numeric_limits<float>::max());
+  next_.assign(n, -1);
+
+  typedef std::pair<float, int> HeapEntry;
+  auto heap_compare = std::greater<HeapEntry>();
+  std::vector<HeapEntry> heap;
+  dist_[destination] = 0;
+  heap.push_back({0, destination});
+  while (!heap.empty()) {
+    std::pop_heap(heap.begin(), heap.end(), heap_compare);
+    HeapEntry top = heap.back();
+    heap.pop_back();
+    int u = top.second;
+    if (top.first > dist_[u]) {
+      continue;
+    }
+    // every w that can enter u gets closer through u
+    for (int e = graph.ReverseRowBegin(u); e < graph.ReverseRowEnd(u); e++) {
+      int w = graph.ReverseColumn(e);
+      float d = dist_[u] + graph.ReverseWeight(e);
+      if (d < dist_[w]) {
+        dist_[w] = d;
+        next_[w] = u;
+        heap.push_back({d, w});
+        std::push_heap(heap.begin(), heap.end(), heap_compare);
+      }
+    }
+  }
+}
+
+bool ShortestPathTree::GetPath(int src, std::vector<int>& path) const {
+  path.clear();
+  if (!CanReach(src)) {
+    return false;
+  }
+  for (int v = src; v != -1; v = next_[v]) {
+    path.push_back(v);
+  }
+  return true;
+}
@@ -0,0 +1,139 @@
+#ifndef TAXIGRAPH_H
+#define TAXIGRAPH_H
+
+#include <cstdint>
+#include <vector>
+#include "RouteBase.h"
+
+enum RouteSearchMode {
+  DIJKSTRA,
+  ASTAR, // Dijkstra guided by the straight line distance to the target
+};
+
+// Compressed sparse row (CSR) adjacency of all the segments of an airport.
+// Row i lists the segments that can be entered from segment i. The weight of
+// every edge leaving segment i is the length of segment i, so the distance of
+// a node is measured from the start of the source segment to its own start.
+// Memory is O(V + E) instead of the O(V^2) of a dense connection matrix.
+class TaxiGraph {
+  public:
+    TaxiGraph();
+
+    // Build the adjacency from the out_segment lists. segments[i] must be the
+    // segment with matrix id i.
+    void Build(const std::vector<SegmentInfo>& segments);
+
+    int GetNumOfNodes() const { return int(row_offsets_.size()) - 1; }
+    int GetNumOfEdges() const { return int(columns_.size()); }
+
+    // Neighbours of node are columns_[RowBegin(node)] .. columns_[RowEnd(node) - 1]
+    int RowBegin(int node) const { return row_offsets_[node]; }
+    int RowEnd(int node) const { return row_offsets_[node + 1]; }
+    int Column(int edge) const { return columns_[edge]; }
+    float Weight(int edge) const { return weights_[edge]; }
+
+    // Same layout for the transposed graph: row i lists the segments that can
+    // enter segment i, with the weight of that edge in the forward graph.
+    int ReverseRowBegin(int node) const { return reverse_row_offsets_[node]; }
+    int ReverseRowEnd(int node) const { return reverse_row_offsets_[node + 1]; }
+    int ReverseColumn(int edge) const { return reverse_columns_[edge]; }
+    float ReverseWeight(int edge) const { return reverse_weights_[edge]; }
+
+    // Real world positions where a segment is entered and left.
+    sf::Vector2f GetStartPosition(int node) const { return start_positions_[node]; }
+    sf::Vector2f GetEndPosition(int node) const { return end_positions_[node]; }
+    float GetLength(int node) const { return lengths_[node]; }
+
+    // A* heuristic: a path from node to target must cover the whole of node
+    // and then at least the straight line from its end to the target start.
+    // Never overestimates, so A* keeps returning shortest paths.
+    float EstimateDistance(int node, int target) const;
+
+  private:
+    std::vector<int> row_offsets_; // size V + 1
+    std::vector<int> columns_;     // size E
+    std::vector<float> weights_;   // size E
+
+    std::vector<int> reverse_row_offsets_;
+    std::vector<int> reverse_columns_;
+    std::vector<float> reverse_weights_;
+
+    std::vector<sf::Vector2f> start_positions_;
+    std::vector<sf::Vector2f> end_positions_;
+    std::vector<float> lengths_;
+};
+
+// Shortest paths from every node to one fixed destination, built by running
+// Dijkstra from the destination on the transposed graph. Any route ending at
+// the destination is then read by following next hops, O(path length).
+class ShortestPathTree {
+  public:
+    void Build(const TaxiGraph& graph, int destination);
+
+    int GetDestination() const { return destination_; }
+    bool CanReach(int src) const { return src == destination_ || next_[src] != -1; }
+    float GetDistance(int src) const { return dist_[src]; }
+
+    // Node ids from src to the destination, both included. Returns false if
+    // the destination can not be reached from src.
+    bool GetPath(int src, std::vector<int>& path) const;
+
+  private:
+    int destination_ = -1;
+    std::vector<float> dist_;
+    std::vector<int> next_; // next node towards the destination, -1 if none
+};
+
+// Reusable shortest path search over a TaxiGraph. The graph is borrowed and
+// never modified; all the scratch buffers are owned by the query and kept
+// between calls, so once they have grown to the graph size a search does not
+// allocate. A query is not shared between threads: each thread uses its own
+// query on the same graph.
+class RouteQuery {
+  public:
+    explicit RouteQuery(const TaxiGraph* graph = nullptr);
+
+    // Point the query to a graph. Buffers are only resized when the graph
+    // has more nodes than before.
+    void Bind(const TaxiGraph* graph);
+
+    // Shortest path from src to dst using a binary heap, O(E log V).
+    // Returns false if dst can not be reached from src.
+    bool Search(int src, int dst, RouteSearchMode mode = RouteSearchMode::DIJKSTRA);
+
+    // Node ids of the last successful search, from src to dst, both included.
+    const std::vector<int>& GetPath() const { return path_; }
+    // Total length of the last successful search.
+    float GetDistance() const { return path_distance_; }
+    // Number of nodes popped from the heap by the last search.
+    int GetNumOfExpandedNodes() const { return num_of_expanded_nodes_; }
+
+  private:
+    struct HeapEntry {
+      float key;  // dist for Dijkstra, dist + estimate for A*
+      float dist;
+      int node;
+      bool operator>(const HeapEntry& other) const { return key > other.key; }
+    };
+
+    // dist_ and from_ of a node are valid only if its stamp equals epoch_,
+    // this saves clearing the buffers before every search.
+    bool IsTouched(int node) const { return stamp_[node] == epoch_; }
+    void NextEpoch();
+
+  private:
+    const TaxiGraph* graph_;
+
+    uint32_t epoch_ = 0;
+    std::vector<uint32_t> stamp_;
+    std::vector<float> dist_;
+    std::vector<float> estimate_; // A* estimate to the target, computed once per node
+    std::vector<int> from_;
+    std::vector<HeapEntry> heap_;
+
+    std::vector<int> path_;
+    float path_distance_ = 0;
+    int num_of_expanded_nodes_ = 0;
+};
+
+#endif // TAXIGRAPH_H
@@ -0,0 +1,214 @@
+#include "TaxiPath.h"
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <math.h>
+#include "Utils.h"
+
+void TaxiPath::Compile(const TaxiRoute& routes, bool direction, float distance) {
+  Clear();
+  routes_ = routes;
+  TaxiRouteView view = routes_.View();
+  float dist = distance;
+  for (int i = 0; i < view.Size(); i++) {
+    RouteBase* route = view.Route(i);
+    const ConnectionInfo* hop = view.Hop(i);
+    float exit_distance = hop ? hop->distance_to_break_out : (direction ? route->GetLength() : 0);
+
+    Leg leg;
+    leg.route = route;
+    leg.direction = direction;
+    leg.entry_distance = dist;
+    leg.start = length_;
+    leg.end = length_ + abs(exit_distance - dist);
+    leg.speed_limit = KnotsToMetersPerSecond(route->GetTaxiSpeedLimit());
+    legs_.push_back(leg);
+
+    // hold points are kept sorted along their direction
+    for (auto& p : route->GetHoldPoints(direction)) {
+      if (p.distance_on_route <= std::max(dist, exit_distance) && p.distance_on_route >= std::min(dist, exit_distance)) {
+        holds_.push_back({leg.start + abs(p.distance_on_route - dist), p.type});
+      }
+    }
+    length_ = leg.end;
+
+    if (!hop) {
+      break;
+    }
+    if (hop->direction_allowed_to_enter_next_route != direction) {
+      std::cerr << "Taxi direction "
+                << (direction ? "Positive" : "Negative")
+                << " of " << route->GetName() << " is not allowed to enter "
+                << hop->next_piece->GetName()
+                << std::endl;
+      break;
+    }
+    dist = hop->distance_to_break_in;
+    direction = hop->positive_entering_next_piece;
+  }
+  routes_.Truncate(legs_.size());
+  std::stable_sort(holds_.begin(), holds_.end(),
+                   [](const HoldMarker& a, const HoldMarker& b) { return a.s < b.s; });
+}
+
+void TaxiPath::Clear() {
+  routes_.Clear();
+  legs_.clear();
+  holds_.clear();
+  leg_ = 0;
+  next_hold_ = 0;
+  released_holds_ = 0;
+  s_ = 0;
+  length_ = 0;
+  profile_.clear();
+}
+
+bool TaxiPath::Advance(float delta_distance) {
+  if (Empty()) {
+    return false;
+  }
+  s_ += delta_distance;
+  while (s_ >= legs_[leg_].end && leg_ + 1 < int(legs_.size())) {
+    leg_++;
+    routes_.PopFront();
+  }
+  if (s_ >= length_) {
+    // no further routes, stop at the end of the last one
+    s_ = length_;
+    routes_.Clear();
+  }
+  while (next_hold_ < int(holds_.size()) && holds_[next_hold_].s < s_) {
+    next_hold_++;
+  }
+  return true;
+}
+
+float TaxiPath::GetDistanceOnRouteAt(double s) const {
+  const Leg& leg = legs_[leg_];
+  return leg.entry_distance + (leg.direction ? s - leg.start : leg.start - s);
+}
+
+float TaxiPath::GetNextSpeedLimit() const {
+  return leg_ + 1 < int(legs_.size()) ? legs_[leg_ + 1].speed_limit : 0;
+}
+
+float TaxiPath::GetDistanceToNextHold(HoldPointType& next_hold_type) {
+  if (Empty()) {
+    std::cerr << "Taxi routes shouldn't be empty" << std::endl;
+    next_hold_type = HoldPointType::NOTSET;
+    return 0;
+  }
+  if (next_hold_ < int(holds_.size())) {
+    next_hold_type = holds_[next_hold_].type;
+    return holds_[next_hold_].s - s_;
+  }
+  float res = GetRemainingDistance();
+  if (res == 0) {
+    next_hold_type = HoldPointType::NOTSET;
+  }
+  return res;
+}
+
+void TaxiPath::PlanSpeedProfile(float speed, float acceleration, float deceleration, bool hold_short) {
+  profile_.clear();
+  if (Empty()) {
+    return;
+  }
+  // 1. where the plan ends: the first hold to stop at, or the end of the path
+  profile_start_ = s_;
+  profile_end_ = length_;
+  if (hold_short) {
+    for (int i = std::max(next_hold_, released_holds_); i < int(holds_.size()); i++) {
+      if (holds_[i].type == HoldPointType::TAKEOFF || holds_[i].type == HoldPointType::TRAFFIC) {
+        profile_end_ = std::max(holds_[i].s, s_);
+        break;
+      }
+    }
+  }
+
+  // 2. speed limits, a sample takes the lowest limit of the legs up to the
+  // next sample, so a slower route is never entered above its limit
+  int n = int(ceil((profile_end_ - profile_start_) / SPEED_PROFILE_STEP)) + 1;
+  profile_.resize(n);
+  int leg = leg_;
+  for (int i = 0; i < n; i++) {
+    double sample = ProfileSample(i);
+    double next_sample = ProfileSample(i + 1);
+    while (leg + 1 < int(legs_.size()) && legs_[leg].end <= sample) {
+      leg++;
+    }
+    float limit = legs_[leg].speed_limit;
+    for (int j = leg + 1; j < int(legs_.size()) && legs_[j].start < next_sample; j++) {
+      limit = std::min(limit, legs_[j].speed_limit);
+    }
+    profile_[i] = limit;
+  }
+  if (hold_short) {
+    profile_[n - 1] = 0;
+  }
+
+  // 3. forward pass, v^2 = v0^2 + 2 * a * ds
+  float reachable = std::max(speed, 0.0f);
+  for (int i = 1; i < n; i++) {
+    double ds = ProfileSample(i) - ProfileSample(i - 1);
+    reachable = std::min(profile_[i - 1], reachable);
+    reachable = sqrt(reachable * reachable + 2 * acceleration * ds);
+    profile_[i] = std::min(profile_[i], reachable);
+  }
+
+  // 4. backward pass, slow down early enough for every lower sample ahead
+  for (int i = n - 2; i >= 0; i--) {
+    double ds = ProfileSample(i + 1) - ProfileSample(i);
+    float allowed = sqrt(profile_[i + 1] * profile_[i + 1] + 2 * deceleration * ds);
+    profile_[i] = std::min(profile_[i], allowed);
+  }
+}
+
+float TaxiPath::GetPlannedSpeed() const {
+  if (profile_.empty()) {
+    return Empty() ? 0 : GetSpeedLimit();
+  }
+  if (s_ >= profile_end_) {
+    return profile_.back();
+  }
+  int i = int(std::max(s_ - profile_start_, 0.0) / SPEED_PROFILE_STEP);
+  if (i + 1 >= int(profile_.size())) {
+    return profile_.back();
+  }
+  // v^2 is linear in s under constant acceleration, interpolating v itself
+  // would creep towards a stop and never reach it
+  double t = (s_ - ProfileSample(i)) / (ProfileSample(i + 1) - ProfileSample(i));
+  t = std::min(std::max(t, 0.0), 1.0);
+  float v0 = profile_[i] * profile_[i];
+  float v1 = profile_[i + 1] * profile_[i + 1];
+  return sqrt(v0 + (v1 - v0) * t);
+}
+
+double TaxiPath::GetPlannedSpeedRun() const {
+  if (profile_.empty()) {
+    return 0;
+  }
+  int n = int(profile_.size());
+  int i = int(std::max(s_ - profile_start_, 0.0) / SPEED_PROFILE_STEP);
+  if (s_ >= profile_end_ || i + 1 >= n) {
+    return std::numeric_limits<double>::infinity();
+  }
+  // the speed between two equal samples is that of the samples, whatever s
+  int j = i + 1;
+  while (j < n && profile_[j] == profile_[i]) {
+    j++;
+  }
+  if (j == n) {
+    return std::numeric_limits<double>::infinity();
+  }
+  return std::max(ProfileSample(j - 1) - s_, 0.0);
+}
+
+void TaxiPath::ReleaseNextHold() {
+  for (int i = std::max(next_hold_, released_holds_); i < int(holds_.size()); i++) {
+    if (holds_[i].type == HoldPointType::TAKEOFF || holds_[i].type == HoldPointType::TRAFFIC) {
+      released_holds_ = i + 1;
+      return;
+    }
+  }
+}
@@ -0,0 +1,117 @@
+#ifndef TAXIPATH_H
+#define TAXIPATH_H
+
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "RouteBase.h"
+#include "TaxiRoute.h"
+
+// Distance between two samples of the planned speed profile, meter
+#define SPEED_PROFILE_STEP 1.0
+
+// A TaxiRoute compiled once for the position it is started from. The legs,
+// one per route, are laid end to end on a single arc length axis s starting
+// at 0, so following the route is advancing s. Hold points met on the way
+// are stored as markers sorted by s, speed limits are stored per leg. A speed
+// profile over s can be planned from them, so the target speed of a tick is
+// a table lookup.
+class TaxiPath {
+  public:
+    TaxiPath() {}
+
+    // Compile routes for an aircraft at distance on the first route, moving
+    // in direction. Stops at the first hop that can not be taken.
+    void Compile(const TaxiRoute& routes, bool direction, float distance);
+    void Clear();
+
+    // True once the end of the path is reached
+    bool Empty() const { return routes_.Empty(); }
+    // Number of routes left, the current one included
+    int Size() const { return routes_.Size(); }
+    // Connection from the current route to the next one, nullptr on the last route
+    const ConnectionInfo* NextHop() const { return routes_.NextHop(); }
+    TaxiRouteView GetRoutes() const { return routes_.View(); }
+    // Route names joined by ">", for display
+    std::string ToString() const { return routes_.ToString(); }
+
+    // Move delta_distance along the path, stopping at its end. Only the leg
+    // cursor moves, O(1) amortized. Returns false if the path is empty.
+    bool Advance(float delta_distance);
+
+    // Where the aircraft is on its current route. Still valid once the path
+    // is finished: the end of the last route.
+    RouteBase* GetRoute() const { return legs_[leg_].route; }
+    bool GetDirectionOnRoute() const { return legs_[leg_].direction; }
+    float GetDistanceOnRoute() const { return GetDistanceOnRouteAt(s_); }
+    // Same for s further on the current leg
+    float GetDistanceOnRouteAt(double s) const;
+
+    // Distance left on the current route, and to the end of the path
+    float GetDistanceToRouteEnd() const { return legs_[leg_].end - s_; }
+    float GetRemainingDistance() const { return length_ - s_; }
+    // Distance travelled along the path since it was compiled
+    double GetTravelledDistance() const { return s_; }
+
+    // Taxi speed limit of the current and of the next route, in m/s.
+    // The next one is 0 on the last route.
+    float GetSpeedLimit() const { return legs_[leg_].speed_limit; }
+    float GetNextSpeedLimit() const;
+
+    // Plan the target speed for the rest of the path with a forward pass
+    // (acceleration from the current speed) and a backward pass (deceleration
+    // before every slower part), both as positive numbers in m/s^2. With
+    // hold_short the plan stops at the end of the path and at the first
+    // TAKEOFF or TRAFFIC hold point not released yet.
+    void PlanSpeedProfile(float speed, float acceleration, float deceleration, bool hold_short);
+    // Planned speed at the current position, the speed limit if nothing is planned
+    float GetPlannedSpeed() const;
+    // How far ahead the planned speed stays the one at the current position,
+    // infinity if it never changes again. 0 if nothing is planned.
+    double GetPlannedSpeedRun() const;
+    // The aircraft has taken over the stop at the next hold point, e.g. by
+    // entering the Hold state. Later plans go through it.
+    void ReleaseNextHold();
+
+    // Distance to the closest hold point at or ahead of the current position,
+    // next_hold_type is set to its type. If there is none, the remaining
+    // distance is returned and next_hold_type is left untouched, unless the
+    // end is already reached, then it is set to NOTSET.
+    float GetDistanceToNextHold(HoldPointType& next_hold_type);
+
+  private:
+    struct Leg {
+      RouteBase* route;
+      bool direction;
+      float entry_distance; // distance on route where the leg starts
+      double start;         // s at the leg start
+      double end;           // s at the leg end
+      float speed_limit;    // m/s
+    };
+
+    struct HoldMarker {
+      double s;
+      HoldPointType type;
+    };
+
+    // s of profile sample i
+    double ProfileSample(int i) const { return std::min(profile_start_ + i * SPEED_PROFILE_STEP, profile_end_); }
+
+  private:
+    TaxiRoute routes_; // its cursor always points to the route of leg_
+    std::vector<Leg> legs_;
+    std::vector<HoldMarker> holds_;
+    int leg_ = 0;
+    int next_hold_ = 0; // first hold marker not behind s_
+    int released_holds_ = 0; // hold markers before this index are not planned as stops
+    double s_ = 0; // double, so long paths do not lose the small per tick steps
+    double length_ = 0;
+
+    // planned speed at profile_start_ + i * SPEED_PROFILE_STEP, the last
+    // sample is at profile_end_
+    std::vector<float> profile_;
+    double profile_start_ = 0;
+    double profile_end_ = 0;
+};
+
+#endif // TAXIPATH_H
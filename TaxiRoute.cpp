@@ -0,0 +1,59 @@
+#include "TaxiRoute.h"
+#include <iostream>
+
+void TaxiRoute::PushBack(RouteBase* route) {
+  if (!routes_.empty()) {
+    const ConnectionInfo* hop = routes_.back()->FindConnection(route);
+    if (!hop) {
+      std::cerr << routes_.back()->GetName() << " is not connected to "
+                << route->GetName() << std::endl;
+    }
+    hops_.back() = hop;
+  }
+  routes_.push_back(route);
+  hops_.push_back(nullptr);
+}
+
+void TaxiRoute::PopFront() {
+  if (Empty()) {
+    return;
+  }
+  cursor_++;
+  if (Empty()) {
+    Clear();
+  }
+}
+
+void TaxiRoute::Truncate(int size) {
+  if (size <= 0) {
+    Clear();
+    return;
+  }
+  if (size >= Size()) {
+    return;
+  }
+  routes_.resize(cursor_ + size);
+  hops_.resize(cursor_ + size);
+  hops_.back() = nullptr;
+}
+
+void TaxiRoute::Clear() {
+  routes_.clear();
+  hops_.clear();
+  cursor_ = 0;
+}
+
+TaxiRouteView TaxiRoute::View() const {
+  return TaxiRouteView(routes_.data() + cursor_, hops_.data() + cursor_, Size());
+}
+
+std::string TaxiRoute::ToString() const {
+  std::string res = "";
+  for (int i = cursor_; i < int(routes_.size()); i++) {
+    if (i > cursor_) {
+      res += ">";
+    }
+    res += routes_[i]->GetName();
+  }
+  return res;
+}
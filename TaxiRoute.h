@@ -0,0 +1,70 @@
+#ifndef TAXIROUTE_H
+#define TAXIROUTE_H
+
+#include <string>
+#include <vector>
+#include "RouteBase.h"
+
+// Non-owning read only view of the remaining routes of a TaxiRoute. Cheap to
+// copy, valid until the TaxiRoute is modified.
+class TaxiRouteView {
+  public:
+    TaxiRouteView() {}
+    TaxiRouteView(RouteBase* const* routes, const ConnectionInfo* const* hops, int size)
+      : routes_(routes), hops_(hops), size_(size) {}
+
+    bool Empty() const { return size_ == 0; }
+    int Size() const { return size_; }
+
+    RouteBase* Route(int i) const { return routes_[i]; }
+    // Connection from Route(i) to Route(i + 1), nullptr for the last route
+    const ConnectionInfo* Hop(int i) const { return hops_[i]; }
+
+    RouteBase* Front() const { return routes_[0]; }
+    RouteBase* Back() const { return routes_[size_ - 1]; }
+
+  private:
+    RouteBase* const* routes_ = nullptr;
+    const ConnectionInfo* const* hops_ = nullptr;
+    int size_ = 0;
+};
+
+// Routes an aircraft is cleared to taxi along. Routes are kept in one
+// contiguous array with a read cursor: the route under the cursor is the one
+// the aircraft is on, PopFront only moves the cursor. The connection between
+// two consecutive routes is resolved once when the route is appended, so
+// following the route never looks up a connection by name.
+class TaxiRoute {
+  public:
+    TaxiRoute() {}
+
+    // Append a route, resolving the connection from the current last route.
+    void PushBack(RouteBase* route);
+    // Leave the current route.
+    void PopFront();
+    // Keep only the first size routes left.
+    void Truncate(int size);
+    // Storage is kept, a cleared route can be refilled without allocating.
+    void Clear();
+
+    bool Empty() const { return cursor_ == int(routes_.size()); }
+    int Size() const { return int(routes_.size()) - cursor_; }
+
+    RouteBase* Front() const { return routes_[cursor_]; }
+    RouteBase* Back() const { return routes_.back(); }
+    // Connection from the current route to the next one, nullptr if the
+    // current route is the last one.
+    const ConnectionInfo* NextHop() const { return Size() > 1 ? hops_[cursor_] : nullptr; }
+
+    TaxiRouteView View() const;
+
+    // Route names joined by ">", for display
+    std::string ToString() const;
+
+  private:
+    std::vector<RouteBase*> routes_;
+    std::vector<const ConnectionInfo*> hops_; // hops_[i] connects routes_[i] to routes_[i + 1]
+    int cursor_ = 0;
+};
+
+#endif // TAXIROUTE_H
@@ -0,0 +1,112 @@
+#ifndef TIMERWHEEL_H
+#define TIMERWHEEL_H
+
+#include <vector>
+
+#define TIMER_WHEEL_BITS 6
+#define TIMER_WHEEL_SLOTS (1 << TIMER_WHEEL_BITS)
+#define TIMER_WHEEL_LEVELS 4
+
+// Timers counted in simulation ticks, the wheel turns one tick at a time.
+// Level 0 has a slot per tick for the next 64 ticks, a slot of each next
+// level spans the whole level below. A timer waits in the lowest level its
+// due tick fits in and moves down as the wheel turns, so scheduling is O(1)
+// and a timer is moved at most once per level, however long it waits.
+// Nothing is done for the ticks in between.
+template <typename T>
+class TimerWheel {
+  public:
+    TimerWheel() {}
+
+    // due_tick must be after the current tick, an earlier one is due on the
+    // next tick
+    void Schedule(long long due_tick, T value) {
+      if (due_tick <= tick_) {
+        due_tick = tick_ + 1;
+      }
+      Place({due_tick, value});
+      size_++;
+    }
+
+    // Turn to the next tick and append the values due at it to expired
+    void Tick(std::vector<T>& expired) {
+      tick_++;
+      // bring the timers of the higher level slots starting now down, the
+      // highest first, they may land in a lower slot starting now too
+      int top = 0;
+      while (top + 1 < TIMER_WHEEL_LEVELS && (tick_ & (Span(top + 1) - 1)) == 0) {
+        top++;
+      }
+      if (top == TIMER_WHEEL_LEVELS - 1) {
+        Cascade(overflow_);
+      }
+      for (int level = top; level >= 1; level--) {
+        Cascade(slots_[level][SlotIndex(level, tick_)]);
+      }
+      std::vector<Timer>& due = slots_[0][SlotIndex(0, tick_)];
+      for (const Timer& timer : due) {
+        expired.push_back(timer.value);
+      }
+      size_ -= due.size();
+      due.clear();
+    }
+
+    // Drop every timer and start again at tick
+    void Clear(long long tick = 0) {
+      for (auto& level : slots_) {
+        for (auto& slot : level) {
+          slot.clear();
+        }
+      }
+      overflow_.clear();
+      tick_ = tick;
+      size_ = 0;
+    }
+
+    long long GetTick() const { return tick_; }
+    int Size() const { return size_; }
+
+  private:
+    struct Timer {
+      long long due_tick;
+      T value;
+    };
+
+    // ticks spanned by a slot of level
+    static long long Span(int level) {
+      return 1LL << (TIMER_WHEEL_BITS * level);
+    }
+    static int SlotIndex(int level, long long tick) {
+      return (tick >> (TIMER_WHEEL_BITS * level)) & (TIMER_WHEEL_SLOTS - 1);
+    }
+
+    void Place(Timer timer) {
+      long long delta = timer.due_tick - tick_;
+      if (delta >= Span(TIMER_WHEEL_LEVELS)) {
+        // beyond the wheel, placed again once the top level turns
+        overflow_.push_back(timer);
+        return;
+      }
+      int level = 0;
+      while (delta >= Span(level + 1)) {
+        level++;
+      }
+      slots_[level][SlotIndex(level, timer.due_tick)].push_back(timer);
+    }
+
+    void Cascade(std::vector<Timer>& slot) {
+      cascading_.swap(slot);
+      for (const Timer& timer : cascading_) {
+        Place(timer);
+      }
+      cascading_.clear();
+    }
+
+    std::vector<Timer> slots_[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+    std::vector<Timer> overflow_;
+    std::vector<Timer> cascading_;
+    long long tick_ = 0;
+    int size_ = 0;
+};
+
+#endif // TIMERWHEEL_H
@@ -1,8 +1,10 @@
 #ifndef UTILS_H
 #define UTILS_H
 
-#include <SFML/Graphics.hpp>
+#include <SFML/System/Vector2.hpp>
+#include <iterator>
 #include <random>
+#include <string>
 
 inline sf::Vector2f ToSfmlPosition(sf::Vector2f world_coordinate) {
   return sf::Vector2f(world_coordinate.x, -1 * world_coordinate.y);
@@ -36,11 +38,16 @@ enum ClickResponse {
   ASSIGN_GATE = 1,
 };
 
+// Uniform random integer in [min, max]. Every random draw of the simulation
+// goes through one seeded engine, so a seed always gives the same game.
+inline int RandomInt(std::mt19937& rng, int min, int max) {
+  return std::uniform_int_distribution<int>(min, max)(rng);
+}
+
 template <typename Iter>
-Iter select_randomly(Iter start, Iter end) {
-  static std::random_device rd;
-  static std::mt19937 gen(rd());
-  return select_randomly(start, end, gen);
+Iter select_randomly(Iter start, Iter end, std::mt19937& rng) {
+  std::advance(start, RandomInt(rng, 0, std::distance(start, end) - 1));
+  return start;
 }
 
 #endif // UTILS_H
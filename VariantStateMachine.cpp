@@ -0,0 +1,118 @@
+#include "VariantStateMachine.h"
+#include <iostream>
+#include <type_traits>
+#include "Aircraft.h"
+#include "SimulationObserver.h"
+
+// The calls are qualified with the concrete state, so they are not virtual
+
+VariantStateMachine::VariantStateMachine(std::shared_ptr<Aircraft> aircraft, SimulationObserver* observer,
+                                          bool log_transitions)
+  : log_transitions_(log_transitions) {
+  context_.aircraft = aircraft;
+  context_.observer = observer;
+  Enter();
+}
+
+StateId VariantStateMachine::GetCurrentStateId() {
+  return StateId(state_.index());
+}
+
+void VariantStateMachine::Update(float dt) {
+  Decide(dt);
+  Commit();
+}
+
+void VariantStateMachine::Decide(float dt) {
+  if (context_.aircraft->IsCruising()) {
+    return;
+  }
+  decided_state_id_ = std::visit([&](const auto& state) {
+    using S = std::decay_t<decltype(state)>;
+    return state.S::Update(context_, dt);
+  }, state_);
+}
+
+void VariantStateMachine::Interrupt() {
+  context_.cruise_ticks = 0;
+  context_.aircraft->EndCruise();
+}
+
+void VariantStateMachine::Commit() {
+  if (context_.aircraft->IsCruising()) {
+    return;
+  }
+  moving_ = false;
+  if (GetCurrentStateId() != decided_state_id_) {
+    TransitToState(decided_state_id_);
+  } else {
+    moving_ = std::visit([](const auto& state) {
+      using S = std::decay_t<decltype(state)>;
+      return state.S::IsMoving();
+    }, state_);
+  }
+  context_.aircraft->SetMoving(moving_);
+}
+
+void VariantStateMachine::Move(float dt) {
+  if (!moving_ || context_.aircraft->IsCruising()) {
+    return;
+  }
+  StateId next_state_id = std::visit([&](const auto& state) {
+    using S = std::decay_t<decltype(state)>;
+    return state.S::Move(context_, dt);
+  }, state_);
+  if (GetCurrentStateId() != next_state_id) {
+    TransitToState(next_state_id);
+  } else if (context_.cruise_ticks > 0) {
+    context_.aircraft->StartCruise(dt);
+  }
+}
+
+int VariantStateMachine::Cruise() {
+  int cruise_ticks = context_.cruise_ticks;
+  context_.cruise_ticks = 0;
+  return cruise_ticks;
+}
+
+void VariantStateMachine::TransitToState(StateId next_state_id) {
+  bool allowed = std::visit([&](const auto& state) {
+    using S = std::decay_t<decltype(state)>;
+    return Allows(typename Transitions<S>::Next(), next_state_id);
+  }, state_);
+  if (!allowed) {
+    std::cerr << context_.aircraft->GetName() << " cannot transit from "
+              << State::Get(GetCurrentStateId())->GetStateName() << " to "
+              << State::Get(next_state_id)->GetStateName() << std::endl;
+    return;
+  }
+  std::visit([&](const auto& state) {
+    using S = std::decay_t<decltype(state)>;
+    state.S::Exit(context_);
+    // destroys state, not used any more
+    Emplace(typename Transitions<S>::Next(), next_state_id);
+  }, state_);
+  Enter();
+}
+
+void VariantStateMachine::Enter() {
+  StateId state_id = GetCurrentStateId();
+  StateId next_state_id = std::visit([&](const auto& state) {
+    using S = std::decay_t<decltype(state)>;
+    if (log_transitions_) {
+      std::cout << context_.aircraft->GetName() << " Transit to " << state.GetStateName() << std::endl;
+    }
+    context_.timer = 0;
+    context_.sleep = 0;
+    context_.cruise_ticks = 0;
+    return state.S::Entry(context_);
+  }, state_);
+  if (next_state_id != state_id) {
+    TransitToState(next_state_id);
+  }
+}
+
+VariantStateMachine::~VariantStateMachine()
+{
+  //dtor
+}
@@ -0,0 +1,78 @@
+#ifndef VARIANTSTATEMACHINE_H
+#define VARIANTSTATEMACHINE_H
+
+#include <memory>
+#include <variant>
+#include "State.h"
+
+class Aircraft;
+class SimulationObserver;
+
+// The states by value, in StateId order, so the index is the StateId
+using StateVariant = std::variant<InitialState, TouchDownState, MaintainSpeedState,
+                                  StopState, IdleState, RequestRunwayState,
+                                  RequestPushBackState, PushBackState,
+                                  TakeOffState, HoldState, LeavingState>;
+static_assert(std::variant_size<StateVariant>::value == NUM_OF_STATES,
+              "StateVariant must hold every state in StateId order");
+
+// The states a state may transit to, from Entry, Update or Move
+template <StateId... next_state_ids>
+struct To {};
+
+template <class S> struct Transitions;
+template <> struct Transitions<InitialState> { using Next = To<TOUCH_DOWN>; };
+template <> struct Transitions<TouchDownState> { using Next = To<MAINTAIN_SPEED>; };
+template <> struct Transitions<MaintainSpeedState> { using Next = To<STOP, IDLE, TAKE_OFF, HOLD>; };
+template <> struct Transitions<StopState> { using Next = To<IDLE>; };
+template <> struct Transitions<IdleState> { using Next = To<MAINTAIN_SPEED, REQUEST_RUNWAY, TAKE_OFF>; };
+template <> struct Transitions<RequestRunwayState> { using Next = To<REQUEST_PUSH_BACK>; };
+template <> struct Transitions<RequestPushBackState> { using Next = To<PUSH_BACK>; };
+template <> struct Transitions<PushBackState> { using Next = To<MAINTAIN_SPEED>; };
+template <> struct Transitions<TakeOffState> { using Next = To<LEAVING>; };
+template <> struct Transitions<HoldState> { using Next = To<MAINTAIN_SPEED, IDLE, TAKE_OFF>; };
+template <> struct Transitions<LeavingState> { using Next = To<>; };
+
+// Same states and same behaviour as StateMachine, but the current state is
+// held by value and every call goes to its concrete type through
+// std::visit, a jump on the variant index instead of a virtual call. Only
+// the transitions of the table are built, any other one is refused.
+class VariantStateMachine
+{
+  public:
+    // log_transitions prints every transition to std::cout
+    VariantStateMachine(std::shared_ptr<Aircraft> aircraft, SimulationObserver* observer,
+                        bool log_transitions = true);
+    ~VariantStateMachine();
+
+    void Update(float dt);
+    void Move(float dt);
+    void Decide(float dt);
+    void Commit();
+    void Interrupt();
+    int Cruise();
+    StateId GetCurrentStateId();
+    void TransitToState(StateId next_state_id);
+
+  private:
+    // Entry of the current state, and on to the state it asks for
+    void Enter();
+
+    template <StateId... next_state_ids>
+    static bool Allows(To<next_state_ids...>, StateId next_state_id) {
+      return ((next_state_id == next_state_ids) || ...);
+    }
+    template <StateId... next_state_ids>
+    void Emplace(To<next_state_ids...>, StateId next_state_id) {
+      (void)((next_state_id == next_state_ids && (state_.emplace<next_state_ids>(), true)) || ...);
+    }
+
+    StateVariant state_;
+    StateId decided_state_id_ = StateId::INITIAL;
+    // the current state moves this tick, it did not transit in Update
+    bool moving_ = false;
+    bool log_transitions_;
+    StateContext context_;
+};
+
+#endif // VARIANTSTATEMACHINE_H
@@ -0,0 +1,68 @@
+#include "WorkerPool.h"
+
+WorkerPool::WorkerPool(int num_of_threads) {
+  for (int i = 1; i < num_of_threads; i++) {
+    threads_.emplace_back(&WorkerPool::WorkerLoop, this, i);
+  }
+}
+
+WorkerPool::~WorkerPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  start_condition_.notify_all();
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+}
+
+void WorkerPool::ParallelFor(int n, const std::function<void(int)>& task) {
+  if (threads_.empty() || n <= 1) {
+    for (int i = 0; i < n; i++) {
+      task(i);
+    }
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    task_ = &task;
+    n_ = n;
+    num_of_busy_workers_ = threads_.size();
+    loop_id_++;
+  }
+  start_condition_.notify_all();
+  RunChunk(0);
+  std::unique_lock<std::mutex> lock(mutex_);
+  done_condition_.wait(lock, [this]() { return num_of_busy_workers_ == 0; });
+  task_ = nullptr;
+}
+
+void WorkerPool::WorkerLoop(int worker) {
+  long long last_loop_id = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      start_condition_.wait(lock, [&]() { return stop_ || loop_id_ != last_loop_id; });
+      if (stop_) {
+        return;
+      }
+      last_loop_id = loop_id_;
+    }
+    RunChunk(worker);
+    std::lock_guard<std::mutex> lock(mutex_);
+    num_of_busy_workers_--;
+    if (num_of_busy_workers_ == 0) {
+      done_condition_.notify_one();
+    }
+  }
+}
+
+void WorkerPool::RunChunk(int k) {
+  long long num_of_chunks = GetNumOfThreads();
+  int begin = n_ * k / num_of_chunks;
+  int end = n_ * (k + 1) / num_of_chunks;
+  for (int i = begin; i < end; i++) {
+    (*task_)(i);
+  }
+}
@@ -0,0 +1,46 @@
+#ifndef WORKERPOOL_H
+#define WORKERPOOL_H
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A fixed set of worker threads running one parallel loop at a time. The
+// loop is split into contiguous chunks, one per thread, the calling thread
+// takes the first one. There is no work stealing, the tasks of a loop are
+// expected to cost about the same.
+class WorkerPool {
+  public:
+    // num_of_threads counts the calling thread, 1 or less runs every loop
+    // on the calling thread only
+    WorkerPool(int num_of_threads);
+    ~WorkerPool();
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    int GetNumOfThreads() const { return int(threads_.size()) + 1; }
+
+    // Run task(i) for every i in [0, n) and return once all are done
+    void ParallelFor(int n, const std::function<void(int)>& task);
+
+  private:
+    void WorkerLoop(int worker);
+    // Run the tasks of chunk k of the current loop
+    void RunChunk(int k);
+
+  private:
+    std::vector<std::thread> threads_;
+    std::mutex mutex_;
+    std::condition_variable start_condition_;
+    std::condition_variable done_condition_;
+
+    const std::function<void(int)>* task_ = nullptr;
+    int n_ = 0;
+    long long loop_id_ = 0; // increased for every loop, wakes the workers
+    int num_of_busy_workers_ = 0;
+    bool stop_ = false;
+};
+
+#endif // WORKERPOOL_H
@@ -3,28 +3,233 @@
 #include <iostream>
 #include <unordered_map>
 #include <list>
-#include <stack>
 #include <memory>
 #include <iomanip>
 #include <sstream>
+#include <chrono>
 
 #include "RouteBase.h"
 #include "Airport.h"
 #include "Aircraft.h"
 #include "Utils.h"
 #include "StateMachine.h"
+#include "VariantStateMachine.h"
 #include "BannerPanel.h"
 #include "Banner.h"
+#include "Simulation.h"
+#include "AutoController.h"
+#include "GroundView.h"
 
 #define PI 3.1415926536
+// Ticks one frame runs at most while warping, 2 mins of simulation time
+#define WARP_TICKS_PER_FRAME 7200
 
 // 1. Self: ends, directions, meshed points(position, distance to the end), display shapes
 // 2. Connection info, [breakout point, next element]
 // 3. Computation, next position.
 
-int main() {
-  /* initialize random seed: */
-  srand(time(NULL));
+// app and font are nullptr without a window
+std::shared_ptr<Airport> CreateAirport(sf::RenderWindow* app, sf::Font* font) {
+  // Airport params
+  float global_ds = 0.5;
+
+  float runway_width = 46;
+  sf::Color runway_color = sf::Color(37, 40, 45, 255);
+
+  float taxiway_width = 22;
+  sf::Color taxiway_color = sf::Color(150, 150, 150, 255);
+  sf::Color transparent_color = sf::Color::Transparent;
+
+  float gate_width = 60;
+  float gate_display_length = 80;
+  float gate_length = 45;
+  // sf::Color gate_color = sf::Color(70, 70, 70, 255);
+  sf::Color gate_color = transparent_color;
+
+  bool mode = true;
+  std::shared_ptr<Airport> airport = std::make_shared<Airport>(app, font, global_ds, runway_width, runway_color,
+                  taxiway_width, taxiway_color, gate_length, gate_width,
+                  gate_display_length, gate_color, mode);
+  airport->SetWindDirection(220);
+  return airport;
+}
+
+// Run the simulation without a window for duration seconds of simulation
+// time, every request answered at once, as fast as possible.
+void RunHeadless(float duration, unsigned int seed, int num_of_threads) {
+  std::shared_ptr<Airport> airport = CreateAirport(nullptr, nullptr);
+  AutoController controller(airport);
+  Simulation simulation(airport, seed);
+  simulation.SetNumOfThreads(num_of_threads);
+  simulation.AddObserver(&controller);
+  simulation.AddAircraft(AircraftIdentification({"CZ3525", "A320", "A320neo_CFM_AIB_VT.png", 37.57, 35.8, -3.0}),
+                         airport->GetActiveRunwayInfo()[0]);
+
+  auto start = std::chrono::steady_clock::now();
+  while (simulation.GetTime() < duration && !simulation.IsGameOver()) {
+    simulation.Step();
+  }
+  std::chrono::duration<double> wall_time = std::chrono::steady_clock::now() - start;
+  std::cout << "Simulated " << simulation.GetTime() << " s in " << wall_time.count() << " s, "
+            << simulation.GetTotalTakeOff() << " take off"
+            << (simulation.IsGameOver() ? ", game over" : "") << std::endl;
+}
+
+// Land num_of_aircrafts aircraft driven by Machine at once and run them for
+// duration seconds of simulation time, every request answered at once.
+// Returns the wall time of the ticks, digest sums where the aircraft ended.
+template <class Machine>
+double RunStateMachineFleet(int num_of_aircrafts, float duration, unsigned int seed, double& digest) {
+  std::shared_ptr<Airport> airport = CreateAirport(nullptr, nullptr);
+  AutoController controller(airport);
+  std::mt19937 rng(seed);
+  KinematicsTable kinematics;
+  std::vector<std::shared_ptr<Aircraft>> aircrafts;
+  std::vector<std::unique_ptr<Machine>> state_machines;
+  std::vector<Machine*> machine_of_slot;
+  std::vector<int> wake_requests;
+  std::vector<int> cruise_end_tick(num_of_aircrafts, -1);
+  auto runway_infos = airport->GetActiveRunwayInfo();
+  AircraftIdentification id({"", "A320", "A320neo_CFM_AIB_VT.png", 37.57, 35.8, -3.0});
+  for (int i = 0; i < num_of_aircrafts; i++) {
+    id.name = "BM" + std::to_string(i);
+    aircrafts.push_back(std::make_shared<Aircraft>(id, airport, &rng, &kinematics, kinematics.Allocate()));
+    aircrafts.back()->SetLandingRunwayInfo(runway_infos[i % runway_infos.size()]);
+    aircrafts.back()->SetWakeRequests(&wake_requests);
+    state_machines.push_back(std::make_unique<Machine>(aircrafts.back(), &controller, false));
+    machine_of_slot.resize(kinematics.Capacity());
+    machine_of_slot[aircrafts.back()->GetSlot()] = state_machines.back().get();
+  }
+
+  float dt = SIMULATION_TICK;
+  int num_of_ticks = duration / dt;
+  auto start = std::chrono::steady_clock::now();
+  for (int t = 0; t < num_of_ticks; t++) {
+    // told something or done cruising, the machine decides again
+    for (int slot : wake_requests) {
+      machine_of_slot[slot]->Interrupt();
+    }
+    wake_requests.clear();
+    for (int i = 0; i < num_of_aircrafts; i++) {
+      if (cruise_end_tick[i] == t) {
+        state_machines[i]->Interrupt();
+      }
+    }
+    for (auto& state_machine : state_machines) {
+      state_machine->Decide(dt);
+    }
+    for (auto& state_machine : state_machines) {
+      state_machine->Commit();
+    }
+    kinematics.Integrate(dt);
+    for (int i = 0; i < num_of_aircrafts; i++) {
+      state_machines[i]->Move(dt);
+      int ticks = state_machines[i]->Cruise();
+      if (ticks > 0) {
+        cruise_end_tick[i] = t + ticks + 1;
+      }
+    }
+  }
+  std::chrono::duration<double> wall_time = std::chrono::steady_clock::now() - start;
+
+  digest = 0;
+  for (int i = 0; i < num_of_aircrafts; i++) {
+    sf::Vector2f position = aircrafts[i]->GetPosition();
+    digest += state_machines[i]->GetCurrentStateId() + position.x + position.y;
+  }
+  return wall_time.count();
+}
+
+// Compare StateMachine and VariantStateMachine on the same fleet. Both
+// must end the same, their transitions are not logged.
+void BenchmarkStateMachines(int num_of_aircrafts, unsigned int seed) {
+  float duration = 600;
+  double digests[2];
+  double seconds[2] = {
+      RunStateMachineFleet<StateMachine>(num_of_aircrafts, duration, seed, digests[0]),
+      RunStateMachineFleet<VariantStateMachine>(num_of_aircrafts, duration, seed, digests[1])};
+  double num_of_updates = double(num_of_aircrafts) * int(duration / float(SIMULATION_TICK));
+  for (int i = 0; i < 2; i++) {
+    std::cout << (i == 0 ? "virtual" : "variant")
+              << " aircraft: " << num_of_aircrafts
+              << " total: " << seconds[i] * 1000 << " ms"
+              << " per aircraft tick: " << seconds[i] * 1e9 / num_of_updates << " ns"
+              << std::endl;
+  }
+  std::cout << (digests[0] == digests[1] ? "same result" : "results differ") << std::endl;
+}
+
+// A larger aircraft type makes the conflict grid start again with larger
+// cells. An aircraft parked asleep at its gate has to be in it afterwards,
+// or nothing taxiing is checked against it until it wakes.
+bool CheckConflictGridAfterLargerType(unsigned int seed) {
+  std::shared_ptr<Airport> airport = CreateAirport(nullptr, nullptr);
+  AutoController controller(airport);
+  Simulation simulation(airport, seed);
+  simulation.SetAutoGenerateTraffic(false);
+  simulation.AddObserver(&controller);
+  SlotHandle handle = simulation.AddAircraft(
+      AircraftIdentification({"CZ3525", "A320", "A320neo_CFM_AIB_VT.png", 37.57, 35.8, -3.0}),
+      airport->GetActiveRunwayInfo()[0]);
+  auto parked = [&]() {
+    for (const SimulatedAircraft& entry : simulation.GetAircrafts()) {
+      if (entry.aircraft == simulation.GetAircraft(handle)) {
+        return entry.asleep && entry.aircraft->IsActive() &&
+               entry.state_machine.GetCurrentStateId() == StateId::IDLE;
+      }
+    }
+    return false;
+  };
+  while (!parked() && simulation.GetTime() < 3600 && !simulation.IsGameOver()) {
+    simulation.Step();
+  }
+  if (!parked()) {
+    std::cout << "conflict grid: the aircraft never parked asleep" << std::endl;
+    return false;
+  }
+  simulation.AddAircraft(AircraftIdentification({"UAL101", "A380", "A380.png", 72.85, 79.88, -3.0}),
+                         airport->GetActiveRunwayInfo()[0]);
+  bool in_grid = simulation.GetConflictGrid().Contains(simulation.GetAircraft(handle)->GetSlot());
+  std::cout << "conflict grid: the parked aircraft is "
+            << (in_grid ? "still in it" : "missing") << std::endl;
+  return in_grid;
+}
+
+int main(int argc, char* argv[]) {
+  // --seed N replays the game of seed N, the seed is printed otherwise
+  // --threads N lets N threads update the aircraft, the game is the same
+  unsigned int seed = time(NULL);
+  int num_of_threads = 1;
+  for (int i = 1; i + 1 < argc; i++) {
+    if (std::string(argv[i]) == "--seed") {
+      seed = strtoul(argv[i + 1], nullptr, 10);
+    } else if (std::string(argv[i]) == "--threads") {
+      num_of_threads = atoi(argv[i + 1]);
+    }
+  }
+  std::cout << "Seed: " << seed << std::endl;
+
+  // Compare Dijkstra and A* on every segment pair of this airport, then quit
+  if (argc > 1 && std::string(argv[1]) == "--benchmark-route") {
+    CreateAirport(nullptr, nullptr)->BenchmarkRouteSearch(20);
+    return 0;
+  }
+  // Compare the virtual and the variant state machine on a fleet, then quit
+  if (argc > 1 && std::string(argv[1]) == "--benchmark-state-machine") {
+    bool has_num = argc > 2 && std::string(argv[2]).rfind("--", 0) != 0;
+    BenchmarkStateMachines(has_num ? atoi(argv[2]) : 1000, seed);
+    return 0;
+  }
+  // Check the conflict grid keeps dormant aircraft, then quit
+  if (argc > 1 && std::string(argv[1]) == "--check-conflict-grid") {
+    return CheckConflictGridAfterLargerType(seed) ? 0 : 1;
+  }
+  // --headless [seconds], no window is created
+  if (argc > 1 && std::string(argv[1]) == "--headless") {
+    bool has_duration = argc > 2 && std::string(argv[2]).rfind("--", 0) != 0;
+    RunHeadless(has_duration ? atof(argv[2]) : 3600, seed, num_of_threads);
+    return 0;
+  }
 
   // Create the main window
   int screen_width = sf::VideoMode::getDesktopMode().width;
@@ -73,63 +278,26 @@ int main() {
 
   uint32_t frame_count = 0;
 
-  // Airport params
-  float global_ds = 0.5;
-
-  float runway_width = 46;
-  sf::Color runway_color = sf::Color(37, 40, 45, 255);
-
-  float taxiway_width = 22;
-  sf::Color taxiway_color = sf::Color(150, 150, 150, 255);
-  sf::Color transparent_color = sf::Color::Transparent;
-
-  float gate_width = 60;
-  float gate_display_length = 80;
-  float gate_length = 45;
-  // sf::Color gate_color = sf::Color(70, 70, 70, 255);
-  sf::Color gate_color = transparent_color;
-
-  bool mode = true;
-  std::shared_ptr<Airport> airport = std::make_shared<Airport>(&app, &font, global_ds, runway_width, runway_color,
-                  taxiway_width, taxiway_color, gate_length, gate_width,
-                  gate_display_length, gate_color, mode);
-  airport->SetWindDirection(220);
-
-  // Add an aircraft calling name pool
-  std::vector<std::string> calling_name_pool = {
-      /*United*/ "UAL",  /*American*/ "AAL", /*Southwest*/ "SWA",
-      /*JetBlue*/ "JBU", /*Alaska*/ "ASA",   /*Delta*/ "DAL"};
-
-  // Add aircraft identification pool
-  std::vector<AircraftIdentification> aircraft_identification_pool = {
-      {"", "A320", "A320neo_CFM_AIB_VT.png", 37.57, 35.8, -3.0},
-      {"", "A350", "A350-1000_T.png", 73.79, 64.75, -3.0},
-      {"", "A380", "A380.png", 72.85, 79.88, -3.0}};
-
+  std::shared_ptr<Airport> airport = CreateAirport(&app, &font);
 
   std::shared_ptr<BannerPanel> panel = std::make_shared<BannerPanel>(
           sf::Vector2f(ground_view_width, 0), panel_view_width, window_height, &app, &font, &gui, airport);
+  GroundView ground_view(&app, &font);
 
-  std::vector<std::shared_ptr<Aircraft>> aircrafts;
-  std::vector<std::unique_ptr<StateMachine>> state_machines;
-
-  aircrafts.push_back(std::make_shared<Aircraft>(AircraftIdentification({"CZ3525", "A320", "A320neo_CFM_AIB_VT.png", 37.57, 35.8, -3.0}), &app, &font, airport));
-  aircrafts.back()->SetLandingRunwayInfo(airport->GetActiveRunwayInfo()[0]);
-  state_machines.push_back(std::make_unique<StateMachine>(aircrafts.back(), panel));
+  Simulation simulation(airport, seed);
+  simulation.SetNumOfThreads(num_of_threads);
+  simulation.AddObserver(panel.get());
+  simulation.AddObserver(&ground_view);
+  simulation.AddAircraft(AircraftIdentification({"CZ3525", "A320", "A320neo_CFM_AIB_VT.png", 37.57, 35.8, -3.0}),
+                         airport->GetActiveRunwayInfo()[0]);
 
   // Game params
   float dt = 0.0;
-  float dt_scaled = 0.0;
   float time_accumulator = 0.0; // elapsed time in real world, regardless of speed_coeff
-  float time_accumulator_scaled = 0.0;
-  float last_generate_traffic_time = 0;
   sf::Clock clock;
   float speed_coeff = 1;
-
-  bool is_game_over = false;
-  bool is_auto_generate_traffic = true;
-  int auto_generate_traffic_interval = 600; // 10 min
-  int total_take_off = 0;
+  // run to the next request, over as many frames as it takes
+  bool warping = false;
 
   // TGUI code
   tgui::Label::Ptr airport_name_label = tgui::Label::create();
@@ -172,21 +340,6 @@ int main() {
   simulation_speed_label->setTextSize(20);
   simulation_speed_label->getRenderer()->setTextColor(sf::Color::Red);
 
-  auto GenerateTraffic = [&]() {
-    int random_number = rand() % 6 + 1;
-    int aircraft_id_pool_index = random_number <= 4 ? 0 : (random_number == 5 ? 1 : 2);
-    AircraftIdentification id =
-        aircraft_identification_pool[aircraft_id_pool_index];
-    id.name = calling_name_pool[rand() % calling_name_pool.size()] +
-              std::to_string(rand() % 899 + 101);
-    aircrafts.push_back(std::make_shared<Aircraft>(id, &app, &font, airport));
-    auto runway_infos = airport->GetActiveRunwayInfo();
-    int random_runway_number = rand() % int(runway_infos.size());
-    aircrafts.back()->SetLandingRunwayInfo(runway_infos[random_runway_number]);
-    state_machines.push_back(
-        std::make_unique<StateMachine>(aircrafts.back(), panel));
-  };
-
   tgui::Button::Ptr land_one = tgui::Button::create();
   gui.add(land_one);
   land_one->setSize(70, 30);
@@ -195,7 +348,20 @@ int main() {
   land_one->getRenderer()->setBorders(3);
   land_one->getRenderer()->setBorderColor(sf::Color::Blue);
   land_one->getRenderer()->setBorderColorHover(sf::Color::Yellow);
-  land_one->connect("pressed", GenerateTraffic);
+  land_one->connect("pressed", [&]() { simulation.GenerateTraffic(); });
+
+  tgui::Button::Ptr warp = tgui::Button::create();
+  gui.add(warp);
+  warp->setSize(70, 30);
+  warp->setPosition(ground_view_width - 140, 30);
+  warp->setText("WARP");
+  warp->getRenderer()->setBorders(3);
+  warp->getRenderer()->setBorderColor(sf::Color::Blue);
+  warp->getRenderer()->setBorderColorHover(sf::Color::Yellow);
+  warp->connect("pressed", [&]() {
+    warping = !warping;
+    warp->setText(warping ? "STOP" : "WARP");
+  });
 
   tgui::Slider::Ptr simulation_speed_slider = tgui::Slider::create();
   gui.add(simulation_speed_slider);
@@ -245,18 +411,13 @@ int main() {
   restart_game_button->setPosition(ground_view_width / 2, window_height / 2);
   restart_game_button->setText("Restart");
   restart_game_button->connect("pressed", [&]() {
-    aircrafts.clear();
-    state_machines.clear();
-    panel->Clear();
-    airport->Reset();
-    is_game_over = false;
+    simulation.Reset();
     time_accumulator = 0;
-    time_accumulator_scaled = 0;
-    last_generate_traffic_time = 0;
-    total_take_off = 0;
+    warping = false;
+    warp->setText("WARP");
     restart_game_button->setVisible(false);
     exit_button->setVisible(false);
-    GenerateTraffic();
+    simulation.GenerateTraffic();
   });
   restart_game_button->setVisible(false);
 
@@ -282,18 +443,12 @@ int main() {
     frame_count++;
     dt = clock.restart().asSeconds();
     time_accumulator += dt;
-    dt_scaled = dt * speed_coeff;
-    time_accumulator_scaled += dt_scaled;
-    if (!is_game_over) {
-      time_label->setText(ConvertSecondsToHHMMSS(time_accumulator_scaled));
+    if (!simulation.IsGameOver()) {
+      time_label->setText(ConvertSecondsToHHMMSS(simulation.GetTime()));
       fps_label->setText("fps: " + std::to_string(int(round(1 / dt))));
-      total_take_off_label->setText("TAKE OFF:\n" + std::to_string(total_take_off));
-      if (is_auto_generate_traffic && time_accumulator_scaled - last_generate_traffic_time > auto_generate_traffic_interval) {
-        GenerateTraffic();
-        last_generate_traffic_time = time_accumulator_scaled;
-        auto_generate_traffic_interval = auto_generate_traffic_interval + rand() % 60;
-      }
+      total_take_off_label->setText("TAKE OFF:\n" + std::to_string(simulation.GetTotalTakeOff()));
     }
+    panel->Update();
 
     // 1. Clear screen
     app.clear(ground_background_color);
@@ -302,16 +457,14 @@ int main() {
 
     airport->Draw();
 
-    for (auto& aircraft : aircrafts) {
-      aircraft->Draw();
-    }
+    ground_view.Draw();
 
     wind_triangle.setRotation(airport->GetWindDirection());
     wind_indicator->clear(ground_background_color);
     wind_indicator->draw(wind_triangle);
     gui.draw();
 
-    if (is_game_over) {
+    if (simulation.IsGameOver()) {
       app.draw(game_over_text);
     }
 
@@ -373,54 +526,23 @@ int main() {
       }
     }
 
-    if (is_game_over) {
+    if (simulation.IsGameOver()) {
       continue;
     }
-    // 3. Update aircraft dynamics
-    for (auto& sm : state_machines) {
-      sm->Update(dt_scaled);
-    }
-    std::stack<int> aircraft_deletion_index;
-    for (int i=0; i<aircrafts.size(); i++) {
-      if (aircrafts[i]->CanBeDeleted()) {
-        aircraft_deletion_index.push(i);
+    // 3. Update aircraft dynamics, remove the ones left and check game over.
+    // The speed only changes how many fixed ticks run in this frame, a warp
+    // runs them until the next request.
+    if (warping) {
+      if (simulation.Warp(WARP_TICKS_PER_FRAME)) {
+        warping = false;
+        warp->setText("WARP");
       }
+    } else {
+      simulation.Advance(dt * speed_coeff);
     }
-    while (!aircraft_deletion_index.empty()) {
-      aircrafts.erase(aircrafts.begin() + aircraft_deletion_index.top());
-      state_machines.erase(state_machines.begin() + aircraft_deletion_index.top());
-      aircraft_deletion_index.pop();
-      total_take_off++;
-    }
-
-    // 4. Check game over
-    for(int i=0; i<aircrafts.size(); i++) {
-      if (!aircrafts[i]->IsActive()) {
-        continue;
-      }
-      auto pos1 = aircrafts[i]->GetPosition();
-      for (int j=i+1; j<aircrafts.size(); j++) {
-        if (!aircrafts[j]->IsActive()) {
-          continue;
-        }
-        auto pos2 = aircrafts[j]->GetPosition();
-        // sf::Rect intersects doesn't work well since if rotated, the global bound box doesn't rotate, just expands.
-        if (aircrafts[i]->Intersect(aircrafts[j])) {
-          std::cout << aircrafts[i]->GetName() << " at: x " << pos1.x << " y " << pos1.y << std::endl;
-          std::cout << aircrafts[j]->GetName() << " at: x " << pos2.x << " y " << pos2.y << std::endl;
-          is_game_over = true;
-          aircrafts[i]->SetCircleIndicatorColor(sf::Color::Red);
-          aircrafts[j]->SetCircleIndicatorColor(sf::Color::Red);
-          break;
-        }
-      }
-      if (is_game_over) {
-        restart_game_button->setVisible(true);
-        exit_button->setVisible(true);
-        std::cout << "Game over" << std::endl;
-        break;
-      }
-
+    if (simulation.IsGameOver()) {
+      restart_game_button->setVisible(true);
+      exit_button->setVisible(true);
     }
   }
 